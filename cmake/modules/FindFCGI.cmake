@@ -0,0 +1,23 @@
+# - Try to find the FastCGI development kit library
+# Once done this will define
+#
+#  FCGI_FOUND - system has the FastCGI library
+#  FCGI_INCLUDE_DIR - the FastCGI include directory
+#  FCGI_LIBRARIES - The libraries needed to use FastCGI
+#
+# Based on FindIDN.cmake
+# Distributed under the BSD license.
+
+if (FCGI_INCLUDE_DIR AND FCGI_LIBRARIES)
+  # Already in cache, be silent
+  set(FCGI_FIND_QUIETLY TRUE)
+endif (FCGI_INCLUDE_DIR AND FCGI_LIBRARIES)
+
+FIND_PATH(FCGI_INCLUDE_DIR fcgiapp.h PATH_SUFFIXES fastcgi)
+
+FIND_LIBRARY(FCGI_LIBRARIES NAMES fcgi)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(FCGI DEFAULT_MSG FCGI_INCLUDE_DIR FCGI_LIBRARIES )
+
+MARK_AS_ADVANCED(FCGI_INCLUDE_DIR FCGI_LIBRARIES)
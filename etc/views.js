@@ -7,19 +7,9 @@ function out(val) {
 }
 
 function absURL(thread, message, method, query) {
-  var base = configparser.getByPath("system/urls/base", false);
-  var url = base + thread.id;
-  if(message) {
-    url += "/" + message.id;
-  }
-  if(method) {
-    url += ";" + method;
-  }
-  if(query) {
-    url += "?" + url;
-  }
-
-  return url;
+  return router.absURL(thread, message, method, query);
 }
 
-
+function urlFor(name, vars) {
+  return router.urlFor(name, vars);
+}
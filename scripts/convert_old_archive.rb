@@ -135,6 +135,11 @@ def thread_id(thread)
   id
 end
 
+# what Models::Thread::touch() does; without the stamp the thread list can't answer with 304
+def touch_threadlist
+  $db['meta'].update({'_id' => 'threadlist'}, {'$inc' => {'version' => 1}, '$set' => {'modified' => Time.now}}, :upsert => true)
+end
+
 def find_in_dir(dir)
   puts "Handling #{dir}"
 
@@ -164,6 +169,8 @@ def find_in_dir(dir)
       thread['archived'] = (dir =~ /messages/ ? false : true)
 
       puts "saving #{thread['_id']} from file #{dir + '/' + ent}"
+      thread['version'] = 1
+      thread['modified'] = Time.now
       $db['threads'].insert(thread)
       #$db.save_doc(thread)
     rescue
@@ -176,5 +183,6 @@ def find_in_dir(dir)
 end
 
 find_in_dir(directory)
+touch_threadlist
 
 # eof
@@ -35,10 +35,42 @@ typedef union _sa_t {
   struct sockaddr_in sa_inet;
 } sa_t;
 
+#ifdef HAVE_SYS_EPOLL_H
+static bool wantsHTTP(int argc, char *argv[]) {
+  for(int i = 1; i < argc; ++i) {
+    if(strcmp(argv[i], "-l") == 0 || strncmp(argv[i], "--listen", 8) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+#endif
+
 int main(int argc, char *argv[]) {
   sa_t sa;
   socklen_t len = sizeof(sa);
 
+#ifdef HAVE_SYS_EPOLL_H
+  /* when we shall listen on a socket ourselves we are the web server */
+  if(wantsHTTP(argc, argv)) {
+    try {
+      CForum::HTTPApplication app;
+      app.scanArgs(argc, argv);
+      app.configure();
+
+      CForum::PreforkSupervisor supervisor(&app);
+      supervisor.run();
+    }
+    catch(CForum::CForumException &e) {
+      std::cerr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+#endif
+
   /* if we can get the peer name on stdout (fd 0) or the error is not
    * „not a connection“ (ENOTCON), then we are in FastCGI mode. Shamelessly
    * stolen from PHP ;-)
@@ -46,6 +78,18 @@ int main(int argc, char *argv[]) {
   errno = 0;
   if(getpeername(0, (struct sockaddr *)&sa, &len) != 0 && errno == ENOTCONN) {
     // fastcgi
+    try {
+      CForum::FastCGIApplication app;
+      app.scanArgs(argc, argv);
+      app.configure();
+
+      CForum::PreforkSupervisor supervisor(&app);
+      supervisor.run();
+    }
+    catch(CForum::CForumException &e) {
+      std::cerr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
   }
   else {
     // not fastcgi
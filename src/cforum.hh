@@ -31,6 +31,7 @@
 #define CFORUM_H
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -45,6 +46,12 @@
 
 #include "framework/application.hh"
 #include "framework/cgi_application.hh"
+#include "framework/fastcgi_application.hh"
+#include "framework/prefork_supervisor.hh"
+
+#ifdef HAVE_SYS_EPOLL_H
+#include "framework/http_application.hh"
+#endif
 
 #include "exceptions/cforum_exception.hh"
 #include "framework/redirect_exception.hh"
@@ -0,0 +1,300 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Request body parser implementation
+ * \package cgi
+ *
+ * The body parser is fed the request body in chunks and understands
+ * application/x-www-form-urlencoded and multipart/form-data; memory use is
+ * bounded by the configured limits, larger uploads go to temporary files
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "cgi/body_parser.hh"
+
+namespace CForum {
+  BodyParser::Limits::Limits() : maxBodySize(8 * 1024 * 1024), maxFieldSize(1024 * 1024), spillSize(64 * 1024), tempDir("/tmp") { }
+
+  boost::shared_ptr<const BodyParser::Limits> BodyParser::defaultLimits = boost::make_shared<BodyParser::Limits>();
+  pthread_mutex_t BodyParser::limitsLock = PTHREAD_MUTEX_INITIALIZER;
+
+  BodyParser::BodyParser(CGI &c, const std::string &content_type) : cgi(c), multipart(false), state(StatePreamble), delimiter(), pending(), total(0), fieldLength(0), partName(), partValue(), upload(), limits(getLimits()) {
+    std::string boundary = boundaryOf(content_type);
+
+    /* anything but multipart is taken as urlencoded, like we always did */
+    if(!boundary.empty()) {
+      multipart = true;
+      delimiter = "\015\012--" + boundary;
+
+      /* so that the first boundary looks like all the others */
+      pending = "\015\012";
+    }
+  }
+
+  void BodyParser::setLimits(boost::shared_ptr<const Limits> lim) {
+    pthread_mutex_lock(&limitsLock);
+    defaultLimits = lim;
+    pthread_mutex_unlock(&limitsLock);
+  }
+
+  boost::shared_ptr<const BodyParser::Limits> BodyParser::getLimits() {
+    boost::shared_ptr<const Limits> lim;
+
+    pthread_mutex_lock(&limitsLock);
+    lim = defaultLimits;
+    pthread_mutex_unlock(&limitsLock);
+
+    return lim;
+  }
+
+  std::string BodyParser::headerParameter(const std::string &value, const char *name) {
+    size_t pos = value.find(';'), end, len = strlen(name);
+    std::string retval;
+
+    while(pos != std::string::npos) {
+      for(++pos; pos < value.length() && (value[pos] == ' ' || value[pos] == '\011'); ++pos) ;
+
+      if(strncasecmp(value.c_str() + pos, name, len) == 0 && pos + len < value.length() && value[pos + len] == '=') {
+        pos += len + 1;
+
+        if(pos < value.length() && value[pos] == '"') {
+          for(++pos; pos < value.length() && value[pos] != '"'; ++pos) {
+            if(value[pos] == '\\' && pos + 1 < value.length()) {
+              ++pos;
+            }
+
+            retval += value[pos];
+          }
+        }
+        else {
+          end    = value.find(';', pos);
+          retval = value.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+
+          while(!retval.empty() && (retval[retval.length() - 1] == ' ' || retval[retval.length() - 1] == '\011')) {
+            retval.erase(retval.length() - 1);
+          }
+        }
+
+        return retval;
+      }
+
+      pos = value.find(';', pos);
+    }
+
+    return retval;
+  }
+
+  std::string BodyParser::boundaryOf(const std::string &content_type) {
+    if(strncasecmp(content_type.c_str(), "multipart/form-data", 19) != 0) {
+      return std::string();
+    }
+
+    return headerParameter(content_type, "boundary");
+  }
+
+  void BodyParser::feed(const char *buff, size_t len) {
+    const char *amp;
+
+    if((total += len) > limits->maxBodySize) {
+      throw CGIParserException("Request body too large!", CGIParserException::BodyTooLarge);
+    }
+
+    if(multipart) {
+      pending.append(buff, len);
+      process();
+      return;
+    }
+
+    /* urlencoded data is parsed when complete, we only watch the field sizes */
+    for(const char *ptr = buff, *end = buff + len; ptr < end; ptr = amp + 1) {
+      amp = (const char *)memchr(ptr, '&', end - ptr);
+      fieldLength += (amp ? amp : end) - ptr;
+
+      if(fieldLength > limits->maxFieldSize) {
+        throw CGIParserException("Form field too large!", CGIParserException::FieldTooLarge);
+      }
+
+      if(amp == NULL) {
+        break;
+      }
+
+      fieldLength = 0;
+    }
+
+    pending.append(buff, len);
+  }
+
+  void BodyParser::process() {
+    size_t pos, keep = delimiter.length() - 1;
+
+    for(;;) {
+      switch(state) {
+        case StatePreamble:
+        case StateBody:
+          if((pos = pending.find(delimiter)) == std::string::npos) {
+            /* hold back what could be the start of a delimiter */
+            if(pending.length() > keep) {
+              if(state == StateBody) {
+                partData(pending.data(), pending.length() - keep);
+              }
+
+              pending.erase(0, pending.length() - keep);
+            }
+
+            return;
+          }
+
+          if(state == StateBody) {
+            partData(pending.data(), pos);
+            endPart();
+          }
+
+          pending.erase(0, pos + delimiter.length());
+          state = StateDelimiter;
+          break;
+
+        case StateDelimiter:
+          if(pending.length() < 2) {
+            return;
+          }
+
+          if(pending.compare(0, 2, "--") == 0) {
+            state = StateEpilogue;
+            break;
+          }
+
+          /* there may be transport padding after the boundary */
+          if((pos = pending.find("\015\012")) == std::string::npos) {
+            if(pending.length() > MaxHeaderSize) {
+              throw CGIParserException("Malformed multipart boundary!", CGIParserException::MalformedBody);
+            }
+
+            return;
+          }
+
+          pending.erase(0, pos + 2);
+          state = StateHeaders;
+          break;
+
+        case StateHeaders:
+          if(pending.compare(0, 2, "\015\012") == 0) {
+            pos = 0;
+          }
+          else if((pos = pending.find("\015\012\015\012")) != std::string::npos) {
+            pos += 2;
+          }
+          else {
+            if(pending.length() > MaxHeaderSize) {
+              throw CGIParserException("Multipart headers too large!", CGIParserException::MalformedBody);
+            }
+
+            return;
+          }
+
+          startPart(pending.substr(0, pos));
+          pending.erase(0, pos + 2);
+          state = StateBody;
+          break;
+
+        case StateEpilogue:
+          pending.clear();
+          return;
+      }
+    }
+  }
+
+  void BodyParser::startPart(const std::string &headers) {
+    size_t pos = 0, end, colon;
+    std::string line, disposition, type, filename;
+
+    while((end = headers.find("\015\012", pos)) != std::string::npos) {
+      line = headers.substr(pos, end - pos);
+      pos  = end + 2;
+
+      if((colon = line.find(':')) == std::string::npos) {
+        continue;
+      }
+
+      for(end = colon + 1; end < line.length() && (line[end] == ' ' || line[end] == '\011'); ++end) ;
+
+      if(strncasecmp(line.c_str(), "Content-Disposition", colon) == 0 && colon == 19) {
+        disposition = line.substr(end);
+      }
+      else if(strncasecmp(line.c_str(), "Content-Type", colon) == 0 && colon == 12) {
+        type = line.substr(end);
+      }
+    }
+
+    partName = headerParameter(disposition, "name");
+    partValue.clear();
+    upload.reset();
+
+    /* a file input without a file still sends an empty filename */
+    if(!(filename = headerParameter(disposition, "filename")).empty()) {
+      upload = boost::make_shared<Upload>(partName, filename, type.empty() ? std::string("application/octet-stream") : type);
+    }
+  }
+
+  void BodyParser::partData(const char *buff, size_t len) {
+    if(upload) {
+      upload->write(buff, len, limits->spillSize, limits->tempDir);
+    }
+    else if(!partName.empty()) {
+      if(partValue.length() + len > limits->maxFieldSize) {
+        throw CGIParserException("Form field too large!", CGIParserException::FieldTooLarge);
+      }
+
+      partValue.append(buff, len);
+    }
+  }
+
+  void BodyParser::endPart() {
+    if(upload) {
+      upload->close();
+      cgi.addUpload(upload);
+      cgi.addParameter('P', partName, upload->getFilename());
+    }
+    else if(!partName.empty()) {
+      cgi.addParameter('P', partName, partValue);
+    }
+
+    upload.reset();
+    partName.clear();
+    partValue.clear();
+  }
+
+  void BodyParser::finish() {
+    if(!multipart) {
+      cgi.parseString(pending.data(), pending.length(), 'P');
+      pending.clear();
+      return;
+    }
+
+    if(state != StateEpilogue) {
+      throw CGIParserException("Multipart body ends prematurely!", CGIParserException::MalformedBody);
+    }
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,116 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Request body parser interface
+ * \package cgi
+ *
+ * The body parser is fed the request body in chunks and understands
+ * application/x-www-form-urlencoded and multipart/form-data; memory use is
+ * bounded by the configured limits, larger uploads go to temporary files
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BODY_PARSER_H
+#define BODY_PARSER_H
+
+#include <string>
+
+#include <cstring>
+#include <cstdlib>
+#include <strings.h>
+#include <pthread.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "cgi/cgi.hh"
+#include "cgi/upload.hh"
+#include "cgi/cgi_parser_exception.hh"
+
+namespace CForum {
+  class BodyParser {
+  public:
+    BodyParser(CGI &, const std::string &);
+
+    void feed(const char *, size_t);
+    void finish();
+
+    static std::string boundaryOf(const std::string &);
+
+    /**
+     * The limits are replaced as a whole when the config is reloaded; a
+     * parser keeps the ones it was created with
+     */
+    class Limits {
+    public:
+      Limits();
+
+      size_t maxBodySize, maxFieldSize, spillSize;
+      std::string tempDir;
+    };
+
+    static void setLimits(boost::shared_ptr<const Limits>);
+    static boost::shared_ptr<const Limits> getLimits();
+
+  private:
+    BodyParser(const BodyParser &);
+    BodyParser &operator=(const BodyParser &);
+
+    enum State {
+      StatePreamble,
+      StateDelimiter,
+      StateHeaders,
+      StateBody,
+      StateEpilogue
+    };
+
+    static const size_t MaxHeaderSize = 8192;
+
+    void process();
+    void startPart(const std::string &);
+    void partData(const char *, size_t);
+    void endPart();
+
+    static std::string headerParameter(const std::string &, const char *);
+
+    CGI &cgi;
+    bool multipart;
+    State state;
+
+    std::string delimiter, pending;
+    size_t total, fieldLength;
+
+    std::string partName, partValue;
+    boost::shared_ptr<Upload> upload;
+
+    boost::shared_ptr<const Limits> limits;
+
+    static boost::shared_ptr<const Limits> defaultLimits;
+    static pthread_mutex_t limitsLock;
+  };
+
+}
+
+#endif
+
+/* eof */
@@ -29,53 +29,110 @@
  */
 
 #include "cgi/cgi.hh"
+#include "cgi/body_parser.hh"
 
 namespace CForum {
-  CGI::CGI() : _get_values(), _post_values(), _cookie_values(), _cgi_values() {}
+  CGI::ParameterChain::ParameterChain() : first(NoParameter), last(NoParameter) { }
 
-  CGI::CGI(const CGI &c) : _get_values(c._get_values), _post_values(c._post_values), _cookie_values(c._cookie_values), _cgi_values(c._cgi_values) {
+  CGI::ParameterList::ParameterList() : data(), params(), index() { }
+
+  /* names get indexed right away, values stay raw until somebody asks */
+  void CGI::ParameterList::add(RawParameter &param) {
+    const char *raw = data->data() + param.name;
+    std::string name;
+
+    if(params.size() >= MaxParameters) {
+      throw CGIParserException("Too many parameters!", CGIParserException::TooManyValues);
+    }
+
+    if(param.encoded && (memchr(raw, '%', param.nameLength) != NULL || memchr(raw, '+', param.nameLength) != NULL)) {
+      decodeUTF8(raw, param.nameLength, name);
+    }
+    else {
+      name.assign(raw, param.nameLength);
+    }
+
+    ParameterChain &chain = index[name];
+
+    param.next = NoParameter;
+    params.push_back(param);
+
+    if(chain.last == NoParameter) {
+      chain.first = params.size() - 1;
+    }
+    else {
+      params[chain.last].next = params.size() - 1;
+    }
+
+    chain.last = params.size() - 1;
+  }
+
+  const CGI::RawParameter *CGI::ParameterList::first(const std::string &name) const {
+    const ParameterChain *chain = index.find(name);
+    return chain ? &params[chain->first] : NULL;
+  }
+
+  void CGI::ParameterList::valueOf(const RawParameter &param, std::string &value) const {
+    if(param.encoded) {
+      decodeUTF8(data->data() + param.value, param.valueLength, value);
+    }
+    else {
+      value.append(*data, param.value, param.valueLength);
+    }
+  }
+
+  /* the slices we already have stay valid, we only ever append */
+  std::string &CGI::ParameterList::buffer() {
+    if(!data) {
+      data = boost::make_shared<std::string>();
+    }
+    else if(!data.unique()) {
+      data = boost::make_shared<std::string>(*data);
+    }
+
+    return *data;
+  }
+
+  const std::string CGI::emptyValue;
+
+  CGI::CGI() : _get_params(), _post_params(), _cookie_params(), _get_values(), _post_values(), _cookie_values(), _cgi_values(), _headers(), _uploads() {}
+
+  CGI::CGI(const CGI &c) : _get_params(c._get_params), _post_params(c._post_params), _cookie_params(c._cookie_params), _get_values(c._get_values), _post_values(c._post_values), _cookie_values(c._cookie_values), _cgi_values(c._cgi_values), _headers(c._headers), _uploads(c._uploads) {
   }
 
   const CGI &CGI::operator=(const CGI &to_copy) {
     if(this != &to_copy) {
+      _get_params    = to_copy._get_params;
+      _post_params   = to_copy._post_params;
+      _cookie_params = to_copy._cookie_params;
       _get_values    = to_copy._get_values;
       _post_values   = to_copy._post_values;
       _cookie_values = to_copy._cookie_values;
       _cgi_values    = to_copy._cgi_values;
+      _headers       = to_copy._headers;
+      _uploads       = to_copy._uploads;
     }
 
     return *this;
   }
 
-  void CGI::saveParam(const UnicodeString &name, const UnicodeString &value, CGIValueContainer_t *container) {
-    CGIValueContainer_t::iterator it = (*container).find(name);
-
-    if(it != container->end()) {
-      it->second->push_back(value);
-    }
-    else {
-      ArgumentListType vec(new std::vector<UnicodeString>());
-      vec->push_back(value);
-      (*container)[name] = vec;
-    }
-  }
-
-  void CGI::parseString(const char *data, const char realm) {
-    const char  *pos = data, *pos1 = data;
-    UnicodeString name,value;
-    int len = 0, namlen = 0, vallen = 0, num = 0;
+  CGI::ParameterList *CGI::parameterList(const char realm, CGIValueContainer_t **values) {
     CGIValueContainer_t *container;
+    ParameterList *list;
 
     switch(realm) {
       case 'G':
+        list      = &_get_params;
         container = &_get_values;
         break;
 
       case 'P':
+        list      = &_post_params;
         container = &_post_values;
         break;
 
       case 'C':
+        list      = &_cookie_params;
         container = &_cookie_values;
         break;
 
@@ -86,49 +143,135 @@ namespace CForum {
         throw ParameterException(str,ParameterException::InvalidValue);
     }
 
-    while((pos = strstr(pos1,"=")) != NULL) {
-      if(num > 1024) { /* hardcoded maximum number of parameters to parse to prevent hash based DoS */
-        throw CGIParserException("Too many values to decode!", CGIParserException::TooManyValues);
-      }
+    if(values) {
+      *values = container;
+    }
 
-      namlen = pos - pos1;
-      name   = CGI::decode(pos1,namlen);
+    return list;
+  }
 
-      pos1 = strstr(pos,"&");
-      if(!pos1) {
-        break;
+  void CGI::parseString(const char *data, size_t len, const char realm) {
+    CGIValueContainer_t *container;
+    ParameterList *list = parameterList(realm, &container);
+    const char separator = realm == 'C' ? ';' : '&';
+    std::string &buff = list->buffer();
+    size_t pos, end, eq;
+    const char *found;
+    RawParameter param;
+
+    if(!buff.empty()) {
+      buff += separator;
+    }
+
+    pos = buff.length();
+    buff.append(data, len);
+
+    param.encoded = true;
+
+    for(; pos < buff.length(); pos = end + 1) {
+      if((end = buff.find(separator, pos)) == std::string::npos) {
+        end = buff.length();
       }
 
-      ++pos;
+      if(realm == 'C') {
+        for(; pos < end && isspace((unsigned char)buff[pos]); ++pos) ;
+      }
 
-      vallen  = pos1 - pos;
-      value   = CGI::decode(pos,vallen);
+      if(pos == end) {
+        continue;
+      }
 
-      saveParam(name,value,container);
+      param.name = pos;
 
-      ++pos1;
+      /* only look inside this field, a field without = mustn't make us scan the rest again */
+      if((found = (const char *)memchr(buff.data() + pos, '=', end - pos)) == NULL) {
+        param.nameLength  = end - pos;
+        param.value       = end;
+        param.valueLength = 0;
+      }
+      else {
+        eq = found - buff.data();
+        param.nameLength  = eq - pos;
+        param.value       = eq + 1;
+        param.valueLength = end - eq - 1;
+      }
+
+      list->add(param);
     }
 
-    if(pos && *pos) {
-      len   = strlen(pos+1);
-      value = CGI::decode(pos+1,len);
+    /* new values may belong to names we already looked up */
+    container->clear();
+  }
+
+  /* for values that arrive decoded already, e.g. multipart form fields */
+  void CGI::addParameter(const char realm, const std::string &name, const std::string &value) {
+    CGIValueContainer_t *container;
+    ParameterList *list = parameterList(realm, &container);
+    std::string &buff = list->buffer();
+    RawParameter param;
+
+    param.encoded     = false;
+    param.name        = buff.length();
+    param.nameLength  = name.length();
+    param.value       = param.name + name.length();
+    param.valueLength = value.length();
+
+    buff += name;
+    buff += value;
+
+    list->add(param);
+    container->clear();
+  }
+
+  boost::shared_ptr<Upload> CGI::getUpload(const std::string &name) const {
+    std::vector<boost::shared_ptr<Upload> >::const_iterator it, end = _uploads.end();
 
-      saveParam(name,value,container);
+    for(it = _uploads.begin(); it != end; ++it) {
+      if((*it)->getName() == name) {
+        return *it;
+      }
     }
 
-    ++num;
+    return boost::shared_ptr<Upload>();
   }
 
-  CGI CGI::fromCGIEnvironment() {
-    CGI c;
-    char *data = getenv("QUERY_STRING");
-    const char *clen = getenv("CONTENT_LENGTH"),*rqmeth = getenv("REQUEST_METHOD"),**env;
+  CGI::Input::~Input() { }
+
+  class StdinInput : public CGI::Input {
+  public:
+    virtual size_t read(char *buff, size_t len) {
+      return fread(buff, 1, len, stdin);
+    }
+  };
 
+  CGI CGI::fromCGIEnvironment() {
     #ifdef __APPLE__
     const char **environ = const_cast<const char **>(*_NSGetEnviron());
     #endif
 
-    size_t len = 0;
+    StdinInput in;
+    return fromEnvironment(const_cast<const char **>(environ), &in);
+  }
+
+  const char *CGI::getEnvironmentValue(const char * const *env, const char *name) {
+    size_t len = strlen(name);
+
+    for(; *env; ++env) {
+      if(strncmp(*env, name, len) == 0 && (*env)[len] == '=') {
+        return *env + len + 1;
+      }
+    }
+
+    return NULL;
+  }
+
+  CGI CGI::fromEnvironment(const char * const *environment, Input *in) {
+    CGI c;
+    const char *data = getEnvironmentValue(environment, "QUERY_STRING");
+    const char *clen = getEnvironmentValue(environment, "CONTENT_LENGTH"), *rqmeth = getEnvironmentValue(environment, "REQUEST_METHOD");
+    const char * const *env;
+
+    size_t len = 0, got = 0, rd;
 
     const char *cgi_variables[] = {
       "SERVER_SOFTWARE","SERVER_NAME","GATEWAY_INTERFACE",
@@ -136,7 +279,7 @@ namespace CForum {
       "PATH_INFO","PATH_TRANSLATED","SCRIPT_NAME",
       "REMOTE_HOST","REMOTE_ADDR","AUTH_TYPE",
       "REMOTE_USER","REMOTE_IDENT","CONTENT_TYPE",
-      "CONTENT_LENGTH", NULL
+      "CONTENT_LENGTH","HTTPS", NULL
     };
 
     const char **var;
@@ -148,33 +291,40 @@ namespace CForum {
     }
 
     if(data != NULL && *data) {
-      c.parseString(data,'G');
+      c.parseString(data, strlen(data), 'G');
     }
 
-    if(clen && strcmp(rqmeth,"POST") == 0) {
-      len = strtol(clen,NULL,10);
-      data  = new char[len + 1];
+    if(clen && in && strcmp(rqmeth,"POST") == 0) {
+      const char *ctype = getEnvironmentValue(environment, "CONTENT_TYPE");
+      char buff[8192];
 
-      fread(data,1,len,stdin);
-      data[len] = '\0';
+      /* don't even start reading what we would refuse anyway */
+      if((len = strtoul(clen,NULL,10)) > BodyParser::getLimits()->maxBodySize) {
+        throw CGIParserException("Request body too large!", CGIParserException::BodyTooLarge);
+      }
 
-      c.parseString(data,'P');
+      BodyParser parser(c, ctype ? ctype : "");
 
-      delete data;
+      while(got < len && (rd = in->read(buff, std::min(sizeof(buff), len - got))) > 0) {
+        parser.feed(buff, rd);
+        got += rd;
+      }
+
+      parser.finish();
     }
 
-    if((data = getenv("HTTP_COOKIE")) != NULL) {
+    if((data = getEnvironmentValue(environment, "HTTP_COOKIE")) != NULL) {
       c.parseCookies(data);
     }
 
 
     for(var=cgi_variables;*var;++var) {
-      if((data = getenv(*var)) != NULL) {
+      if((data = getEnvironmentValue(environment, *var)) != NULL) {
         c.setCGIVariable(*var,data);
       }
     }
 
-    for(env = const_cast<const char **>(environ); *env; ++env) {
+    for(env = environment; *env; ++env) {
       if(strncmp(*env,"HTTP_",5) == 0 && strcmp(*env,"HTTP_COOKIE") != 0) {
         c.parseHeaderFromCGI(*env);
       }
@@ -208,142 +358,230 @@ namespace CForum {
 
     name = niceHeaderName(name);
 
+    if(_headers.size() >= MaxParameters && !_headers.find(name)) {
+      throw CGIParserException("Too many headers!", CGIParserException::TooManyValues);
+    }
+
     _headers[name] = value;
   }
 
 
   void CGI::parseCookies(const char *cookies) {
-    const char *pos = cookies,*pos1 = cookies;
-    UnicodeString name,value;
-    int len = 0,namlen = 0,vallen = 0;
-
     if(!cookies) {
       throw CGIParserException("Invalid parameter: no cookie value given!",CGIParserException::NoCookiesGiven);
     }
 
-    while((pos = strstr(pos1,"=")) != NULL) {
-      for(;*pos1 && (isspace(*pos1) || *pos1 == ';');++pos1) {}
+    parseString(cookies, strlen(cookies), 'C');
+  }
 
-      namlen = pos - pos1;
-      name   = CGI::decode(pos1,namlen);
+  CGI::ArgumentListType CGI::getValue(const UnicodeString &key, const char *realm) {
+    CGIValueContainer_t *m;
+    const RawParameter *param;
+    ArgumentListType *cached;
+    ParameterList *list;
+    ArgumentListType values;
+    std::string name, value;
 
-      pos1 = strstr(pos,";");
-      if(!pos1) {
-        break;
+    key.toUTF8String(name);
+
+    for(const char *ptr = realm;*ptr;++ptr) {
+      list = parameterList(*ptr, &m);
+
+      if((cached = m->find(name)) != NULL) {
+        if(*cached) {
+          return *cached;
+        }
+
+        continue;
       }
 
-      vallen  = pos1 - pos;
-      value   = CGI::decode(pos+1,vallen-1);
+      if((param = list->first(name)) != NULL) {
+        values = boost::make_shared<std::vector<UnicodeString> >();
 
-      saveParam(name,value,&_cookie_values);
+        for(;;) {
+          value.clear();
+          list->valueOf(*param, value);
+          values->push_back(UnicodeString(value.c_str(), "UTF-8"));
+
+          if(param->next == NoParameter) {
+            break;
+          }
+
+          param = &list->params[param->next];
+        }
+      }
+
+      (*m)[name] = values;
+
+      if(values) {
+        return values;
+      }
     }
 
-    if(pos && *pos) {
-      len   = strlen(pos+1);
-      value = CGI::decode(pos+1,len);
+    return ArgumentListType();
+  }
+
+  std::string CGI::getFirstUTF8Value(const std::string &name, const char *realm) {
+    const RawParameter *param;
+    ParameterList *list;
+    std::string value;
+
+    /* straight from the raw string, no UTF-16 round trip */
+    for(const char *ptr = realm; *ptr; ++ptr) {
+      list = parameterList(*ptr);
 
-      saveParam(name,value,&_cookie_values);
+      if((param = list->first(name)) != NULL) {
+        list->valueOf(*param, value);
+        return value;
+      }
     }
+
+    return value;
   }
 
-  CGI::ArgumentListType CGI::getValue(const UnicodeString &key, const char *realm) {
-    CGIValueContainer_t *m;
-    CGIValueContainer_t::iterator it;
+  static const char hexDigits[] = "0123456789ABCDEF";
 
-    for(const char *ptr = realm;*ptr;++ptr) {
-      switch(*ptr) {
-        case 'G':
-          m = &_get_values;
-          break;
+  static inline int hexValue(unsigned char c) {
+    if(c >= '0' && c <= '9') {
+      return c - '0';
+    }
 
-        case 'P':
-          m = &_post_values;
-          break;
+    c |= 0x20;
+    if(c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
 
-        case 'C':
-          m = &_cookie_values;
-          break;
+    return -1;
+  }
 
-        default:
-          std::string str("Unknown parameter realm ");
-          str += *ptr;
-          str += ". Valid realms are G (GET), P (POST) and C (Cookies).";
+  static inline bool encodeSafe(unsigned char c) {
+    return (c >= 48 && c <= 122) || c == '_' || c == '.' || c == '-';
+  }
 
-          throw ParameterException(str,ParameterException::InvalidValue);
-      }
+  /*
+   * the scanners return the length of the leading run that can be copied
+   * as it is; with SSE2 they look at 16 bytes at a time
+   */
+  static inline size_t plainDecodeRun(const char *str, size_t len) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i pct = _mm_set1_epi8('%'), plus = _mm_set1_epi8('+');
+    __m128i v;
+    int mask;
 
-      if((it = m->find(key)) != m->end()) {
-        return it->second;
+    for(; i + 16 <= len; i += 16) {
+      v    = _mm_loadu_si128((const __m128i *)(str + i));
+      mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, pct), _mm_cmpeq_epi8(v, plus)));
+
+      if(mask != 0) {
+        return i + __builtin_ctz(mask);
       }
     }
+#endif
 
-    return ArgumentListType();
+    for(; i < len && str[i] != '%' && str[i] != '+'; ++i) ;
+
+    return i;
   }
 
+  static inline size_t plainEncodeRun(const char *str, size_t len) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    /* signed compares: bytes from 0x80 on are negative and thus below '0' */
+    const __m128i lo = _mm_set1_epi8(48), hi = _mm_set1_epi8(122), dot = _mm_set1_epi8('.'), dash = _mm_set1_epi8('-');
+    __m128i v, unsafe, allowed;
+    int mask;
 
+    for(; i + 16 <= len; i += 16) {
+      v       = _mm_loadu_si128((const __m128i *)(str + i));
+      unsafe  = _mm_or_si128(_mm_cmplt_epi8(v, lo), _mm_cmpgt_epi8(v, hi));
+      allowed = _mm_or_si128(_mm_cmpeq_epi8(v, dot), _mm_cmpeq_epi8(v, dash));
+      mask    = _mm_movemask_epi8(_mm_andnot_si128(allowed, unsafe));
 
+      if(mask != 0) {
+        return i + __builtin_ctz(mask);
+      }
+    }
+#endif
+
+    for(; i < len && encodeSafe((unsigned char)str[i]); ++i) ;
+
+    return i;
+  }
 
   std::string CGI::encode(const char *str) {
+    size_t len = strlen(str), run;
+    const char *end = str + len;
+    unsigned char c;
     std::string ret;
-    const char *ptr;
-    char buff[10];
 
-    for(ptr=str;*ptr;++ptr) {
-      if((*ptr >= 48 && *ptr <= 122) || (*ptr == '_' || *ptr == '.' || *ptr == '-')) {
-        ret += *ptr;
+    ret.reserve(len + len / 4);
+
+    while(str < end) {
+      run = plainEncodeRun(str, end - str);
+      ret.append(str, run);
+
+      if((str += run) >= end) {
+        break;
+      }
+
+      c = (unsigned char)*str++;
+
+      if(c == ' ') {
+        ret += '+';
       }
       else {
-        if(*ptr == ' ') {
-          ret += '+';
-        }
-        else {
-          snprintf(buff,10,"%%%02X",(int)*ptr);
-          ret += buff;
-        }
+        ret += '%';
+        ret += hexDigits[c >> 4];
+        ret += hexDigits[c & 0xF];
       }
     }
 
     return ret;
   }
 
-  UnicodeString CGI::decode(const char *str,size_t len) {
-    std::string ustr;
-
-    register const char *ptr;
-    char ptr3[3] = { '\0','\0','\0' };
+  void CGI::decodeUTF8(const char *str, size_t len, std::string &ustr) {
+    const char *end;
+    int hi, lo;
+    size_t run;
 
     if(!str) {
       throw CGIParserException("Invalid parameter: string to decode is NULL",CGIParserException::NoDecodeValueGiven);
     }
 
-    for(ptr=str;(size_t)(ptr-str) < len;++ptr) {
-      switch(*ptr) {
-        case '+':
-          ustr += ' ';
-          break;
+    end = str + len;
+    ustr.reserve(ustr.length() + len);
 
-        case '%':
-          /* string is to short; copy remaining bytes and return */
-          if((size_t)(ptr+2 - str) >= len) {
-            ustr += '%';
-            if((size_t)(ptr+1 - str) < len) {
-              ustr += *(ptr+1);
-            }
-
-            return UnicodeString(ustr.c_str(),"UTF-8");
-          }
+    while(str < end) {
+      run = plainDecodeRun(str, end - str);
+      ustr.append(str, run);
 
-          memcpy(ptr3,ptr+1,2);
-          ustr += (char)strtol(ptr3,NULL,16);
-          ptr += 2;
-          break;
+      if((str += run) >= end) {
+        break;
+      }
 
-        default:
-          ustr += (UChar)*ptr;
+      if(*str == '+') {
+        ustr += ' ';
+        ++str;
+      }
+      /* broken or truncated escapes are kept as they are */
+      else if(end - str >= 3 && (hi = hexValue(str[1])) >= 0 && (lo = hexValue(str[2])) >= 0) {
+        ustr += (char)((hi << 4) | lo);
+        str  += 3;
+      }
+      else {
+        ustr += '%';
+        ++str;
       }
     }
+  }
 
+  UnicodeString CGI::decode(const char *str,size_t len) {
+    std::string ustr;
 
+    decodeUTF8(str, len, ustr);
     return UnicodeString(ustr.c_str(),"UTF-8");
   }
 
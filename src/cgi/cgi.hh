@@ -36,9 +36,11 @@
 #include <unicode/unistr.h>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <map>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 
 #ifdef __APPLE__
 #include <crt_externs.h>
@@ -48,16 +50,31 @@
 #include <cstdlib>
 #include <cstring>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "hash_map.hh"
 
+#include "cgi/flat_map.hh"
 #include "cgi/parameter_exception.hh"
 #include "cgi/cgi_parser_exception.hh"
+#include "cgi/upload.hh"
 
 namespace CForum {
   class CGI {
   public:
     typedef boost::shared_ptr<std::vector<UnicodeString> > ArgumentListType;
 
+    /** per realm; a request with more parameters is refused */
+    static const size_t MaxParameters = 1024;
+
+    class Input {
+    public:
+      virtual size_t read(char *, size_t) = 0;
+      virtual ~Input();
+    };
+
     CGI();
     CGI(const CGI &);
 
@@ -66,25 +83,31 @@ namespace CForum {
     void parseString(const UnicodeString &, const char = 'G');
     void parseString(const std::string &, const char = 'G');
     void parseString(const char *, const char = 'G');
+    void parseString(const char *, size_t, const char = 'G');
 
     void parseCookies(const char *);
 
+    void addParameter(const char, const std::string &, const std::string &);
+    void addUpload(boost::shared_ptr<Upload>);
+    boost::shared_ptr<Upload> getUpload(const std::string &) const;
+    const std::vector<boost::shared_ptr<Upload> > &getUploads() const;
+
     void parseHeaderFromCGI(const char *);
 
     void setCGIVariable(const char *,const char *);
-    std::string &getCGIVariable(const char *);
-    std::string &getCGIVariable(const std::string &);
+    const std::string &getCGIVariable(const char *) const;
+    const std::string &getCGIVariable(const std::string &) const;
 
-    std::string &getHeader(const char *);
-    std::string &getHeader(const std::string &);
+    const std::string &getHeader(const char *) const;
+    const std::string &getHeader(const std::string &) const;
 
-    std::string &serverName();
-    std::string &serverProtocol();
-    int serverPort();
-    std::string &requestMethod();
-    std::string &pathInfo();
-    std::string &scriptName();
-    std::string &remoteAddress();
+    const std::string &serverName() const;
+    const std::string &serverProtocol() const;
+    int serverPort() const;
+    const std::string &requestMethod() const;
+    const std::string &pathInfo() const;
+    const std::string &scriptName() const;
+    const std::string &remoteAddress() const;
 
     ArgumentListType getValue(const UnicodeString &, const char * = "GPC");
     ArgumentListType getValue(const std::string &, const char * = "GPC");
@@ -94,29 +117,89 @@ namespace CForum {
     const UnicodeString getFirstValue(const std::string &, const char * = "GPC");
     const UnicodeString getFirstValue(const char *,const char * = "GPC");
 
+    std::string getFirstUTF8Value(const std::string &, const char * = "GPC");
+
 
     static CGI fromCGIEnvironment();
+    static CGI fromEnvironment(const char * const *, Input *);
+
+    static const char *getEnvironmentValue(const char * const *, const char *);
 
     static std::string encode(const UnicodeString &);
-    std::string encode(const std::string &);
+    static std::string encode(const std::string &);
     static std::string encode(const char *);
 
     static UnicodeString decode(const std::string &);
     static UnicodeString decode(const char *,size_t);
+    static void decodeUTF8(const char *, size_t, std::string &);
 
   protected:
-    typedef std::unordered_map<UnicodeString, ArgumentListType, hash_unicodestring> CGIValueContainer_t;
-
-    void saveParam(const UnicodeString &,const UnicodeString &, CGIValueContainer_t *);
-
+    /* keyed by the UTF-8 name */
+    typedef FlatMap<ArgumentListType> CGIValueContainer_t;
+
+    /**
+     * Parameters are kept as slices of the raw query, body or cookie
+     * string and only get decoded when somebody asks for them
+     */
+    class RawParameter {
+    public:
+      size_t name, nameLength, value, valueLength;
+      size_t next; /**< next parameter with the same name or NoParameter */
+      bool encoded;
+    };
+
+    static const size_t NoParameter = (size_t)-1;
+
+    /** first and last parameter of a name */
+    class ParameterChain {
+    public:
+      ParameterChain();
+
+      size_t first, last;
+    };
+
+    class ParameterList {
+    public:
+      ParameterList();
+
+      void add(RawParameter &);
+      const RawParameter *first(const std::string &) const;
+      void valueOf(const RawParameter &, std::string &) const;
+      std::string &buffer();
+
+      boost::shared_ptr<std::string> data;
+      std::vector<RawParameter> params;
+      FlatMap<ParameterChain> index;
+    };
+
+    ParameterList *parameterList(const char, CGIValueContainer_t ** = NULL);
+
+    ParameterList _get_params;
+    ParameterList _post_params;
+    ParameterList _cookie_params;
+
+    /* what has been decoded so far; a NULL list means "looked, not there" */
     CGIValueContainer_t _get_values;
     CGIValueContainer_t _post_values;
     CGIValueContainer_t _cookie_values;
 
-    std::unordered_map<std::string, std::string> _cgi_values;
-    std::unordered_map<std::string, std::string> _headers;
+    /* lookups never insert: a FlatMap moves its values when it grows */
+    FlatMap<std::string> _cgi_values;
+    FlatMap<std::string> _headers;
+
+    static const std::string emptyValue;
+
+    std::vector<boost::shared_ptr<Upload> > _uploads;
   };
 
+  inline void CGI::addUpload(boost::shared_ptr<Upload> upload) {
+    _uploads.push_back(upload);
+  }
+
+  inline const std::vector<boost::shared_ptr<Upload> > &CGI::getUploads() const {
+    return _uploads;
+  }
+
   inline const UnicodeString CGI::getFirstValue(const UnicodeString &key, const char *realm) {
     ArgumentListType u = getValue(key, realm);
     if(u) {
@@ -174,49 +257,50 @@ namespace CForum {
     _cgi_values[name] = value;
   }
 
-  inline std::string &CGI::getCGIVariable(const char *str) {
+  inline const std::string &CGI::getCGIVariable(const char *str) const {
     return getCGIVariable(std::string(str));
   }
 
-  inline std::string &CGI::getCGIVariable(const std::string &name) {
-    return _cgi_values[name];
+  inline const std::string &CGI::getCGIVariable(const std::string &name) const {
+    const std::string *val = _cgi_values.find(name);
+    return val ? *val : emptyValue;
   }
 
-  inline std::string &CGI::serverName() {
+  inline const std::string &CGI::serverName() const {
     return getCGIVariable("SERVER_NAME");
   }
 
-  inline std::string &CGI::serverProtocol() {
+  inline const std::string &CGI::serverProtocol() const {
     return getCGIVariable("SERVER_PROTOCOL");
   }
 
-  inline int CGI::serverPort() {
-    std::string str = getCGIVariable("SERVER_PORT");
-    return atoi(str.c_str());
+  inline int CGI::serverPort() const {
+    return atoi(getCGIVariable("SERVER_PORT").c_str());
   }
 
-  inline std::string &CGI::requestMethod() {
+  inline const std::string &CGI::requestMethod() const {
     return getCGIVariable("REQUEST_METHOD");
   }
 
-  inline std::string &CGI::pathInfo() {
+  inline const std::string &CGI::pathInfo() const {
     return getCGIVariable("PATH_INFO");
   }
 
-  inline std::string &CGI::scriptName() {
+  inline const std::string &CGI::scriptName() const {
     return getCGIVariable("SCRIPT_NAME");
   }
 
-  inline std::string &CGI::remoteAddress() {
+  inline const std::string &CGI::remoteAddress() const {
     return getCGIVariable("REMOTE_ADDRESS");
   }
 
 
-  inline std::string &CGI::getHeader(const char *name) {
+  inline const std::string &CGI::getHeader(const char *name) const {
     return getHeader(std::string(name));
   }
-  inline std::string &CGI::getHeader(const std::string &name) {
-    return _headers[name];
+  inline const std::string &CGI::getHeader(const std::string &name) const {
+    const std::string *val = _headers.find(name);
+    return val ? *val : emptyValue;
   }
 
 
@@ -228,7 +312,11 @@ namespace CForum {
   }
 
   inline void CGI::parseString(const std::string &str, const char realm) {
-    parseString(str.c_str(), realm);
+    parseString(str.data(), str.length(), realm);
+  }
+
+  inline void CGI::parseString(const char *str, const char realm) {
+    parseString(str, strlen(str), realm);
   }
 
 }
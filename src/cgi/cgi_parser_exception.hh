@@ -45,6 +45,10 @@ namespace CForum {
     static const int NoCookiesGiven        = 0x4da962d0;
     static const int NoDecodeValueGiven    = 0x4da96346;
     static const int TooManyValues         = 0x4efc39f5;
+    static const int BodyTooLarge          = 0x4fe9c2a1;
+    static const int FieldTooLarge         = 0x4fe9c2b7;
+    static const int MalformedBody         = 0x4fe9c2cd;
+    static const int UploadError           = 0x4fe9c2e3;
 
   };
 }
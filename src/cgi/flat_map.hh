@@ -0,0 +1,157 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Flat hash map; open addressing with keyed hashes
+ * \package cgi
+ *
+ * A small open addressing hash table for string keys, hashed with SipHash;
+ * used for request parameters, cookies and headers
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "cgi/siphash.hh"
+
+namespace CForum {
+  template<typename T> class FlatMap {
+  public:
+    FlatMap();
+
+    T *find(const std::string &);
+    const T *find(const std::string &) const;
+    T &operator[](const std::string &);
+
+    size_t size() const;
+    void clear();
+
+  private:
+    class Slot {
+    public:
+      Slot();
+
+      std::string key;
+      T value;
+      uint64_t hash;
+      bool used;
+    };
+
+    size_t lookup(const std::string &, uint64_t) const;
+    void grow();
+
+    std::vector<Slot> slots;
+    size_t count;
+  };
+
+  template<typename T> FlatMap<T>::Slot::Slot() : key(), value(), hash(0), used(false) { }
+
+  template<typename T> FlatMap<T>::FlatMap() : slots(), count(0) { }
+
+  /* the slot holding the key or the free one it would go to; linear probing */
+  template<typename T> size_t FlatMap<T>::lookup(const std::string &key, uint64_t hash) const {
+    size_t mask = slots.size() - 1, i = (size_t)hash & mask;
+
+    while(slots[i].used && (slots[i].hash != hash || slots[i].key != key)) {
+      i = (i + 1) & mask;
+    }
+
+    return i;
+  }
+
+  template<typename T> void FlatMap<T>::grow() {
+    std::vector<Slot> old(slots.empty() ? 16 : slots.size() * 2);
+    typename std::vector<Slot>::iterator it, end;
+    size_t i;
+
+    old.swap(slots);
+
+    for(it = old.begin(), end = old.end(); it != end; ++it) {
+      if(it->used) {
+        i = lookup(it->key, it->hash);
+
+        slots[i].key.swap(it->key);
+        std::swap(slots[i].value, it->value);
+        slots[i].hash = it->hash;
+        slots[i].used = true;
+      }
+    }
+  }
+
+  template<typename T> T *FlatMap<T>::find(const std::string &key) {
+    size_t i;
+
+    if(count == 0) {
+      return NULL;
+    }
+
+    i = lookup(key, SipHash::hash(key));
+    return slots[i].used ? &slots[i].value : NULL;
+  }
+
+  template<typename T> const T *FlatMap<T>::find(const std::string &key) const {
+    return const_cast<FlatMap<T> *>(this)->find(key);
+  }
+
+  template<typename T> T &FlatMap<T>::operator[](const std::string &key) {
+    uint64_t hash = SipHash::hash(key);
+    size_t i = slots.empty() ? 0 : lookup(key, hash);
+
+    if(!slots.empty() && slots[i].used) {
+      return slots[i].value;
+    }
+
+    /* at most half full, so probe sequences stay short; growing moves every value */
+    if((count + 1) * 2 > slots.size()) {
+      grow();
+      i = lookup(key, hash);
+    }
+
+    slots[i].key  = key;
+    slots[i].hash = hash;
+    slots[i].used = true;
+    ++count;
+
+    return slots[i].value;
+  }
+
+  template<typename T> inline size_t FlatMap<T>::size() const {
+    return count;
+  }
+
+  template<typename T> void FlatMap<T>::clear() {
+    slots.clear();
+    count = 0;
+  }
+
+}
+
+#endif
+
+/* eof */
@@ -0,0 +1,119 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief SipHash implementation; keyed hashing for request data
+ * \package cgi
+ *
+ * SipHash-2-4 with a random key per process, so that nobody can craft
+ * keys that collide in our hash tables
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "cgi/siphash.hh"
+
+#define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND do {                                                   \
+    v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0; v0 = ROTL(v0, 32);           \
+    v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2;                              \
+    v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0;                              \
+    v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2; v2 = ROTL(v2, 32);           \
+  } while(0)
+
+namespace CForum {
+  uint64_t SipHash::k0 = 0;
+  uint64_t SipHash::k1 = 0;
+  pthread_once_t SipHash::keyOnce = PTHREAD_ONCE_INIT;
+
+  void SipHash::initKey() {
+    uint64_t key[2];
+    FILE *fd;
+
+    if((fd = fopen("/dev/urandom", "rb")) != NULL && fread(key, sizeof(key), 1, fd) == 1) {
+      k0 = key[0];
+      k1 = key[1];
+    }
+    else {
+      /* better than a fixed key */
+      k0 = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+      k1 = (uint64_t)clock() ^ (uint64_t)(size_t)&key;
+    }
+
+    if(fd != NULL) {
+      fclose(fd);
+    }
+  }
+
+  static inline uint64_t readLE64(const unsigned char *p) {
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24) |
+      ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+  }
+
+  uint64_t SipHash::hash(const char *data, size_t len) {
+    const unsigned char *in = (const unsigned char *)data, *end;
+    uint64_t v0, v1, v2, v3, m, b = (uint64_t)len << 56;
+    size_t left = len & 7;
+
+    pthread_once(&keyOnce, initKey);
+
+    v0 = k0 ^ 0x736f6d6570736575ULL;
+    v1 = k1 ^ 0x646f72616e646f6dULL;
+    v2 = k0 ^ 0x6c7967656e657261ULL;
+    v3 = k1 ^ 0x7465646279746573ULL;
+
+    for(end = in + len - left; in != end; in += 8) {
+      m   = readLE64(in);
+      v3 ^= m;
+      SIPROUND;
+      SIPROUND;
+      v0 ^= m;
+    }
+
+    switch(left) {
+      case 7: b |= (uint64_t)in[6] << 48; /* fall through */
+      case 6: b |= (uint64_t)in[5] << 40; /* fall through */
+      case 5: b |= (uint64_t)in[4] << 32; /* fall through */
+      case 4: b |= (uint64_t)in[3] << 24; /* fall through */
+      case 3: b |= (uint64_t)in[2] << 16; /* fall through */
+      case 2: b |= (uint64_t)in[1] << 8; /* fall through */
+      case 1: b |= (uint64_t)in[0]; /* fall through */
+      case 0: break;
+    }
+
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+
+    return v0 ^ v1 ^ v2 ^ v3;
+  }
+
+}
+
+/* eof */
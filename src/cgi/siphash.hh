@@ -0,0 +1,67 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief SipHash interface; keyed hashing for request data
+ * \package cgi
+ *
+ * SipHash-2-4 with a random key per process, so that nobody can craft
+ * keys that collide in our hash tables
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <string>
+
+#include <stdint.h>
+#include <cstring>
+#include <ctime>
+#include <cstdio>
+#include <unistd.h>
+#include <pthread.h>
+
+namespace CForum {
+  class SipHash {
+  public:
+    static uint64_t hash(const char *, size_t);
+    static uint64_t hash(const std::string &);
+
+  private:
+    SipHash();
+
+    static void initKey();
+
+    static uint64_t k0, k1;
+    static pthread_once_t keyOnce;
+  };
+
+  inline uint64_t SipHash::hash(const std::string &str) {
+    return hash(str.data(), str.length());
+  }
+
+}
+
+#endif
+
+/* eof */
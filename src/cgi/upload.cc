@@ -0,0 +1,114 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Upload implementation; a file sent with multipart/form-data
+ * \package cgi
+ *
+ * An upload keeps small files in memory and larger ones in a temporary
+ * file which is removed with the upload
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "cgi/upload.hh"
+
+namespace CForum {
+  Upload::Upload(const std::string &nam, const std::string &fname, const std::string &type) : name(nam), filename(fname), contentType(type), data(), path(), size(0), fd(-1) { }
+
+  void Upload::writeFile(const char *buff, size_t len) {
+    ssize_t written;
+
+    while(len > 0) {
+      if((written = ::write(fd, buff, len)) == -1) {
+        if(errno == EINTR) {
+          continue;
+        }
+
+        throw CGIParserException(std::string("Could not write an upload to disk: ") + strerror(errno), CGIParserException::UploadError);
+      }
+
+      buff += written;
+      len  -= (size_t)written;
+    }
+  }
+
+  void Upload::spill(const std::string &dir) {
+    std::string tmpl = dir + "/cforum-upload-XXXXXX";
+    std::vector<char> buff(tmpl.begin(), tmpl.end());
+
+    buff.push_back('\0');
+
+    if((fd = mkstemp(&buff[0])) == -1) {
+      throw CGIParserException(std::string("Could not create a temporary file for an upload: ") + strerror(errno), CGIParserException::UploadError);
+    }
+
+    path = &buff[0];
+
+    writeFile(data.data(), data.length());
+    std::string().swap(data);
+  }
+
+  void Upload::write(const char *buff, size_t len, size_t spill_size, const std::string &dir) {
+    if(path.empty() && data.length() + len > spill_size) {
+      spill(dir);
+    }
+
+    if(path.empty()) {
+      data.append(buff, len);
+    }
+    else {
+      writeFile(buff, len);
+    }
+
+    size += len;
+  }
+
+  void Upload::close() {
+    if(fd != -1) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+
+  std::string Upload::getContents() const {
+    if(path.empty()) {
+      return data;
+    }
+
+    std::ifstream in(path.c_str(), std::ifstream::in | std::ifstream::binary);
+    std::ostringstream ostr;
+
+    ostr << in.rdbuf();
+    return ostr.str();
+  }
+
+  Upload::~Upload() {
+    close();
+
+    if(!path.empty()) {
+      unlink(path.c_str());
+    }
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,107 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Upload interface; a file sent with multipart/form-data
+ * \package cgi
+ *
+ * An upload keeps small files in memory and larger ones in a temporary
+ * file which is removed with the upload
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+#include "cgi/cgi_parser_exception.hh"
+
+namespace CForum {
+  class Upload {
+  public:
+    Upload(const std::string &, const std::string &, const std::string &);
+    ~Upload();
+
+    void write(const char *, size_t, size_t, const std::string &);
+    void close();
+
+    const std::string &getName() const;
+    const std::string &getFilename() const;
+    const std::string &getContentType() const;
+    size_t getSize() const;
+
+    bool isSpilled() const;
+    const std::string &getPath() const;
+    std::string getContents() const;
+
+  private:
+    Upload(const Upload &);
+    Upload &operator=(const Upload &);
+
+    void spill(const std::string &);
+    void writeFile(const char *, size_t);
+
+    std::string name, filename, contentType;
+    std::string data, path;
+    size_t size;
+    int fd;
+  };
+
+  inline const std::string &Upload::getName() const {
+    return name;
+  }
+
+  inline const std::string &Upload::getFilename() const {
+    return filename;
+  }
+
+  inline const std::string &Upload::getContentType() const {
+    return contentType;
+  }
+
+  inline size_t Upload::getSize() const {
+    return size;
+  }
+
+  inline bool Upload::isSpilled() const {
+    return !path.empty();
+  }
+
+  inline const std::string &Upload::getPath() const {
+    return path;
+  }
+
+}
+
+#endif
+
+/* eof */
@@ -29,6 +29,9 @@
 #cmakedefine HAVE_GETLINE
 #cmakedefine HAVE_GETDELIM
 
+#cmakedefine HAVE_SYS_EPOLL_H
+#cmakedefine HAVE_SYS_INOTIFY_H
+
 #endif
 
 /* eof */
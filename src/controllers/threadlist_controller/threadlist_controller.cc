@@ -45,9 +45,7 @@ namespace CForum {
   void ThreadlistController::preRoute(boost::shared_ptr<Request> rq) {
     CGI c = rq->getCGI();
 
-    std::string t, m;
-    c.getFirstValue("t").toUTF8String(t);
-    c.getFirstValue("m").toUTF8String(m);
+    std::string t = c.getFirstUTF8Value("t"), m = c.getFirstUTF8Value("m");
 
     if(!t.empty()) {
       std::auto_ptr<mongo::DBClientCursor> cursor = app->getMongo()->query("threads", QUERY("tid" << "t" + t));
@@ -77,7 +75,52 @@ namespace CForum {
 
   }
 
-  const std::string ThreadlistController::handleRequest(boost::shared_ptr<Request> rq, const std::map<std::string, std::string> &vars) {
+  /* the page differs per user and per media type, so does its validator */
+  std::string ThreadlistController::listTag(boost::shared_ptr<Request> rq, long long version) {
+    static const char hex[] = "0123456789abcdef";
+    const std::string username = rq->getUser().getUsername();
+    URIPart media = rq->getUri().getMedia();
+    std::ostringstream etag;
+    size_t i;
+
+    etag << "W/\"tl-" << version << "-" << app->getConfigGeneration() << "-";
+
+    /* hex keeps quotes and non-ASCII out of the tag */
+    if(username.empty()) {
+      etag << "anon";
+    }
+    else {
+      etag << "u";
+
+      for(i = 0; i < username.length(); ++i) {
+        etag << hex[(unsigned char)username[i] >> 4] << hex[username[i] & 0xF];
+      }
+    }
+
+    etag << "-";
+
+    for(i = 0; i < media.length(); ++i) {
+      if(isalnum((unsigned char)media.data()[i])) {
+        etag << media.data()[i];
+      }
+    }
+
+    etag << "\"";
+
+    return etag.str();
+  }
+
+  const std::string ThreadlistController::handleRequest(boost::shared_ptr<Request> rq, const std::map<std::string, std::string> &) {
+    long long version;
+    time_t modified;
+
+    /* the stamp is a single point lookup; only a stale client costs the full query */
+    if(Models::Thread::getListStamp(app->getMongo(), version, modified)) {
+      if(rq->notModified(listTag(rq, version), modified)) {
+        return std::string();
+      }
+    }
+
     std::auto_ptr<mongo::DBClientCursor> cursor = app->getMongo()->query("threads", QUERY("archived" << false).sort("messages.0.date"));
     mongo::BSONObj obj;
     v8::Local<v8::Array> ary = v8::Array::New();
@@ -93,8 +136,7 @@ namespace CForum {
 
     tpl->setVariable("threadlist", ary);
 
-    view = "threadlist/threadlist.html";
-    return Controller::handleRequest(rq, vars);
+    return render(rq, "threadlist/threadlist.html");
   }
 
   ThreadlistController::~ThreadlistController() {
@@ -39,6 +39,8 @@
 #include <iostream>
 #include <string>
 
+#include <cctype>
+
 #include "framework/controller.hh"
 #include "framework/route.hh"
 #include "framework/permanent_redirect_exception.hh"
@@ -59,6 +61,9 @@ namespace CForum {
 
     virtual ~ThreadlistController();
 
+  protected:
+    std::string listTag(boost::shared_ptr<Request>, long long);
+
   private:
     ThreadlistController(const ThreadlistController &);
 
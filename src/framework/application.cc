@@ -37,6 +37,7 @@ void usage(const char *bin) {
     "%s [options]\n\n"                                               \
     "where options are:\n"                                           \
     "\t-c, --config-directory Path to the configuration directory\n" \
+    "\t-l, --listen Serve HTTP on host:port or unix:/path\n"         \
     "\t-h, --help Show this help screen\n\n",
     bin
   );
@@ -45,8 +46,20 @@ void usage(const char *bin) {
 
 namespace CForum {
   const char *Application::NOTIFY_PRE_RUN = "notify: just about to run";
+  const char *Application::NOTIFY_THREAD_CHANGED = "notify: thread changed";
+  const char *Application::NOTIFY_MESSAGE_CHANGED = "notify: message changed";
 
-  Application::Application() : mongodb(boost::make_shared<DBClientConnection>()), configparser(boost::make_shared<Configparser>()), router(boost::make_shared<Router>()), notificationCenter(boost::make_shared<NotificationCenter>()), modules(), hooks() {
+  Application::Application() : evaluator(), mongodb(boost::make_shared<DBClientConnection>()), configparser(boost::make_shared<Configparser>()), router(boost::make_shared<Router>()), notificationCenter(boost::make_shared<NotificationCenter>()), responseCache(boost::make_shared<ResponseCache>()), modules(), hooks(), configGeneration(0), requestsHandled(0), maxRequests(0), maxRss(0) {
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&stateLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    /* whoever changes a thread or a message has to post one of these */
+    notificationCenter->registerNotification(NOTIFY_THREAD_CHANGED, responseCache);
+    notificationCenter->registerNotification(NOTIFY_MESSAGE_CHANGED, responseCache);
   }
 
   Application::Application(const Application &) { }
@@ -55,41 +68,395 @@ namespace CForum {
   }
 
   void Application::init() {
+    configure();
+    initWorker();
+  }
+
+  void Application::configure() {
     if(configfile.length() == 0) {
       configfile = configparser->findFile();
     }
 
     configparser->parse(configfile);
+    applySettings(configparser);
+
+    viewsDir = configparser->getNode("system/views", false).asString();
+    baseURL  = configparser->getNode("system/urls/base", false).asString();
+
+    setupUrls(router, baseURL);
+
+    loadExtensions();
     loadModules();
+  }
+
+  /*
+   * the process wide settings are built completely and then published in
+   * one go; requests running keep the set they started with
+   */
+  void Application::applySettings(boost::shared_ptr<Configparser> cfg) {
+    boost::shared_ptr<ResponseCompressor::Settings> compression = boost::make_shared<ResponseCompressor::Settings>();
+    boost::shared_ptr<BodyParser::Limits> limits = boost::make_shared<BodyParser::Limits>();
+
+    const ConfigValue &cache_dir = cfg->getNode("system/code-cache");
+    if(cache_dir.isString()) {
+      CodeCache::setDirectory(cache_dir.asString());
+    }
+
+    /* 0 switches compression off, -1 is zlib's default */
+    const ConfigValue &level = cfg->getNode("system/compression/level");
+    compression->level = level.isNumber() ? (int)level.asInt() : -1;
+
+    const ConfigValue &min_length = cfg->getNode("system/compression/min-length");
+    if(min_length.isNumber()) {
+      compression->minLength = (size_t)min_length.asInt();
+    }
+
+    ResponseCompressor::setSettings(compression);
+
+    const ConfigValue &precompressed = cfg->getNode("system/compression/precompressed-size");
+    if(precompressed.isNumber()) {
+      ResponseCompressor::setPrecompressedLimit((size_t)precompressed.asInt());
+    }
+
+    /* the page cache is off unless it gets some memory */
+    const ConfigValue &cache_size = cfg->getNode("system/cache/size");
+    responseCache->setLimit(cache_size.isNumber() ? (size_t)cache_size.asInt() : 0);
+
+    const ConfigValue &max_age = cfg->getNode("system/cache/max-age");
+    responseCache->setMaxAge(max_age.isNumber() ? (time_t)max_age.asInt() : 0);
+
+    /* the router isn't published yet when we're reloading */
+    const ConfigValue &route_cache = cfg->getNode("system/routing/cache-size");
+    if(route_cache.isNumber()) {
+      router->setCacheLimit((size_t)route_cache.asInt());
+    }
+
+    const ConfigValue &max_body = cfg->getNode("system/uploads/max-body-size");
+    if(max_body.isNumber()) {
+      limits->maxBodySize = (size_t)max_body.asInt();
+    }
+
+    const ConfigValue &max_field = cfg->getNode("system/uploads/max-field-size");
+    if(max_field.isNumber()) {
+      limits->maxFieldSize = (size_t)max_field.asInt();
+    }
+
+    const ConfigValue &spill_size = cfg->getNode("system/uploads/spill-size");
+    if(spill_size.isNumber()) {
+      limits->spillSize = (size_t)spill_size.asInt();
+    }
+
+    const ConfigValue &tmp_dir = cfg->getNode("system/uploads/tmp-dir");
+    if(tmp_dir.isString()) {
+      limits->tempDir = tmp_dir.asString();
+    }
+
+    BodyParser::setLimits(limits);
+  }
+
+  /* modules may register their own templates or replace these; thread ids are paths like /2011/jan/01/slug */
+  void Application::setupUrls(boost::shared_ptr<Router> rtr, const std::string &base) {
+    rtr->setBaseURL(base);
+
+    rtr->registerUrl("thread", "<tid:path>");
+    rtr->registerUrl("message", "<tid:path>/<mid>");
+  }
+
+  void Application::loadExtensions() {
+    const ConfigValue &exts = configparser->getNode("system/views-js");
+    uint32_t i, len;
+
+    if(!exts.isObject() || extensionConfiguration) {
+      return;
+    }
+
+    const ConfigValue::ObjectType &extensions = exts.getObject();
+
+    for(len = (uint32_t)extensions.size(), i = 0; i < len; ++i) {
+      const std::string &file = extensions[i].second.asString();
+      std::ifstream fd(file.c_str(), std::ifstream::in);
+      std::stringstream sst;
+
+      if(!fd) {
+        throw InternalErrorException(std::string("File ") + file + " could not be found!", CForumErrorException::FileNotFound);
+      }
+
+      sst << fd.rdbuf();
+      fd.close();
+
+      extensionNames.push_back(extensions[i].first);
+      extensionSources.push_back(sst.str());
+    }
+
+    if(len == 0) {
+      return;
+    }
+
+    /*
+     * V8 keeps the extensions and their name and source pointers for the
+     * lifetime of the process; they are shared by all isolates
+     */
+    for(i = 0; i < len; ++i) {
+      v8::RegisterExtension(new v8::Extension(extensionNames[i].c_str(), extensionSources[i].c_str()));
+      extensionNamePointers.push_back(extensionNames[i].c_str());
+    }
+
+    extensionConfiguration = boost::make_shared<v8::ExtensionConfiguration>((int)len, &extensionNamePointers[0]);
+  }
+
+  static pthread_key_t workerStateKey;
+  static pthread_once_t workerStateOnce = PTHREAD_ONCE_INIT;
+
+  static void createWorkerStateKey() {
+    pthread_key_create(&workerStateKey, NULL);
+  }
+
+  Application::WorkerState::WorkerState() : evaluator(), mongodb(), templatePool(), routerTemplate(), configparserTemplate(), configCache() { }
+
+  Application::WorkerState::~WorkerState() {
+    if(!routerTemplate.IsEmpty()) {
+      routerTemplate.Dispose();
+    }
+
+    if(!configparserTemplate.IsEmpty()) {
+      configparserTemplate.Dispose();
+    }
+  }
+
+  void Application::setWorkerState(WorkerState *state) {
+    pthread_once(&workerStateOnce, createWorkerStateKey);
+    pthread_setspecific(workerStateKey, state);
+  }
+
+  Application::WorkerState *Application::getWorkerState() {
+    pthread_once(&workerStateOnce, createWorkerStateKey);
+    return reinterpret_cast<WorkerState *>(pthread_getspecific(workerStateKey));
+  }
+
+  boost::shared_ptr<Configparser> Application::getConfigparser() {
+    boost::shared_ptr<Configparser> cfg;
+
+    pthread_mutex_lock(&stateLock);
+    cfg = configparser;
+    pthread_mutex_unlock(&stateLock);
+
+    return cfg;
+  }
+
+  boost::shared_ptr<Router> Application::getRouter() {
+    boost::shared_ptr<Router> rtr;
+
+    pthread_mutex_lock(&stateLock);
+    rtr = router;
+    pthread_mutex_unlock(&stateLock);
+
+    return rtr;
+  }
+
+  std::string Application::getViewsDir() {
+    std::string dir;
+
+    pthread_mutex_lock(&stateLock);
+    dir = viewsDir;
+    pthread_mutex_unlock(&stateLock);
+
+    return dir;
+  }
+
+  std::string Application::getBaseURL() {
+    std::string url;
+
+    pthread_mutex_lock(&stateLock);
+    url = baseURL;
+    pthread_mutex_unlock(&stateLock);
+
+    return url;
+  }
+
+  boost::shared_ptr<DBClientConnection> Application::getMongo() {
+    WorkerState *state = getWorkerState();
+    return state ? state->mongodb : mongodb;
+  }
+
+  boost::shared_ptr<TemplatePool> Application::getTemplatePool() {
+    WorkerState *state = getWorkerState();
+    boost::shared_ptr<TemplatePool> &pool = state ? state->templatePool : templatePool;
+
+    /* contexts belong to an isolate, so the pool is created by the thread using it */
+    if(!pool) {
+      const ConfigValue &check = getConfigparser()->getNode("system/templates/check-mtime");
+      pool = boost::make_shared<TemplatePool>(getExtensionConfiguration(), 4, check.isNull() || check.asBool());
+    }
+
+    return pool;
+  }
+
+  void Application::initWorker() {
+    connectMongo(configparser, mongodb);
+  }
+
+  boost::shared_ptr<Application::WorkerState> Application::createWorkerState() {
+    boost::shared_ptr<WorkerState> state = boost::make_shared<WorkerState>();
+
+    /* the config is a native snapshot, all workers read the one the main thread parsed */
+    state->evaluator = boost::make_shared<JSEvaluator>();
+    state->mongodb   = boost::make_shared<DBClientConnection>();
+    connectMongo(getConfigparser(), state->mongodb);
+
+    return state;
+  }
+
+  void Application::watchConfig() {
+    configWatcher.watch(configfile);
+  }
+
+  void Application::stopWatchingConfig() {
+    configWatcher.stop();
+  }
+
+  bool Application::reloadPending() {
+    return configWatcher.pending();
+  }
+
+  bool Application::waitForReload(int timeout) {
+    return configWatcher.wait(timeout);
+  }
+
+  bool Application::checkReload() {
+    return reloadPending() && reload();
+  }
+
+  void Application::validateConfig(boost::shared_ptr<Configparser> cfg) {
+    static const char *required[] = {
+      "system/views", "system/urls/base", "system/modpath", "mongodb/host", "mongodb/database", NULL
+    };
+
+    for(int i = 0; required[i] != NULL; ++i) {
+      cfg->getNode(required[i], false);
+    }
+
+    if(!cfg->getNode("system/modules", false).isArray()) {
+      throw ConfigErrorException("Key system/modules is not a list of modules!", ConfigErrorException::NotAnObjectError);
+    }
+  }
+
+  /*
+   * V8 knows the views-js extensions for the lifetime of the process, the
+   * template pools fixed check-mtime when they were created and the
+   * connections are set up when a worker starts
+   */
+  static const char *restartKeys[] = {
+    "system/views-js",
+    "system/templates/check-mtime",
+    "system/threads/count",
+    "mongodb",
+    NULL
+  };
+
+  static void warnRestartNeeded(boost::shared_ptr<Configparser> running, boost::shared_ptr<Configparser> cfg) {
+    int i;
+
+    for(i = 0; restartKeys[i] != NULL; ++i) {
+      if(running->getNode(restartKeys[i]) != cfg->getNode(restartKeys[i])) {
+        std::cerr << "WARNING: " << restartKeys[i] << " changed; the change takes effect after a restart" << std::endl;
+      }
+    }
+  }
+
+  bool Application::reload() {
+    typedef std::map<std::string, std::vector<boost::shared_ptr<Controller> > > hooks_t;
+
+    boost::shared_ptr<Configparser> cfg = boost::make_shared<Configparser>(), old_cfg;
+    boost::shared_ptr<Router> old_router;
+    std::vector<cf_module_t> old_modules;
+    hooks_t old_hooks;
+    std::string views, base;
+
+    /* evaluate and validate before anything is touched; a broken file changes nothing */
+    try {
+      cfg->parse(configfile);
+      validateConfig(cfg);
+
+      views = cfg->getNode("system/views", false).asString();
+      base  = cfg->getNode("system/urls/base", false).asString();
+    }
+    catch(CForumException &e) {
+      std::cerr << "ERROR: reloading " << configfile << " failed, keeping the current configuration: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      return false;
+    }
+
+    pthread_mutex_lock(&stateLock);
+
+    old_cfg     = configparser;
+    old_router  = router;
+    old_modules = modules;
+    old_hooks   = hooks;
+
+    /*
+     * requests already running hold on to the old config, router and module
+     * list and finish with them; the last one drops them; module handles are never closed since their code may
+     * still be on some stack
+     */
+    configparser = cfg;
+    router       = boost::make_shared<Router>();
+    modules.clear();
+    hooks.clear();
+
+    setupUrls(router, base);
+
+    try {
+      loadModules();
+    }
+    catch(CForumException &e) {
+      configparser = old_cfg;
+      router       = old_router;
+      modules      = old_modules;
+      hooks        = old_hooks;
+
+      pthread_mutex_unlock(&stateLock);
+
+      std::cerr << "ERROR: reloading the modules failed, keeping the current configuration: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      return false;
+    }
+
+    warnRestartNeeded(old_cfg, cfg);
+
+    viewsDir = views;
+    baseURL  = base;
+
+    applySettings(cfg);
+
+    __sync_add_and_fetch(&configGeneration, 1);
 
-    v8::Local<v8::String>  host     = configparser->getByPath("mongodb/host", false)->ToString();
-    v8::Local<v8::Integer> port     = configparser->getByPath("mongodb/port")->ToInteger();
-    v8::Local<v8::String>  database = configparser->getByPath("mongodb/database", false)->ToString();
+    pthread_mutex_unlock(&stateLock);
 
-    v8::String::Utf8Value host_u(host), database_u(database);
+    return true;
+  }
+
+  void Application::connectMongo(boost::shared_ptr<Configparser> cfg, boost::shared_ptr<DBClientConnection> conn) {
+    const std::string &host     = cfg->getNode("mongodb/host", false).asString();
+    const std::string &database = cfg->getNode("mongodb/database", false).asString();
+    const ConfigValue &user     = cfg->getNode("mongodb/user");
 
     std::string err;
     bool ret;
-    int port_i = port->Int32Value();
+    int port = (int)cfg->getNode("mongodb/port").asInt();
 
-    if(!port->IsNull() && !port->IsUndefined() && port_i != 0) {
-      ret = mongodb->connect(mongo::HostAndPort(*host_u, port_i), err);
+    if(port != 0) {
+      ret = conn->connect(mongo::HostAndPort(host, port), err);
     }
     else {
-      ret = mongodb->connect(*host_u, err);
+      ret = conn->connect(host, err);
     }
 
     if(!ret) {
       throw FrameworkErrorException("Error connecting to MongoDB: " + err, FrameworkErrorException::MongoConnectionError);
     }
 
-    mongodb->setDbName(*database_u);
+    conn->setDbName(database);
 
-    v8::Local<v8::Value> user = configparser->getByPath("mongodb/user");
-    v8::Local<v8::Value> pass = configparser->getByPath("mongodb/password");
-    if(!user->IsNull() && !user->IsUndefined()) {
-      v8::String::Utf8Value user_u(user), pass_u(pass);
-      ret = mongodb->auth(*database_u, *user_u, *pass_u, err);
+    if(!user.isNull()) {
+      ret = conn->auth(database, user.asString(), cfg->getNode("mongodb/password").asString(), err);
 
       if(!ret) {
         throw FrameworkErrorException("Error authenticating to MongoDB: " + err, FrameworkErrorException::MongoConnectionError);
@@ -102,9 +469,10 @@ namespace CForum {
     init();
   }
 
-  static const char *cmdline = "c:h";
+  static const char *cmdline = "c:l:h";
   static struct option cmdline_long[] = {
     { "config", 1, NULL, 'c' },
+    { "listen", 1, NULL, 'l' },
     { "help", 0, NULL, 'h' },
     { NULL, 0, NULL, 0 }
   };
@@ -122,26 +490,41 @@ namespace CForum {
           configfile = optarg;
           break;
 
+        case 'l':
+          if(!optarg) {
+            usage(argv[0]);
+          }
+
+          listenAddress = optarg;
+          break;
+
         default:
           usage(argv[0]);
       }
     }
   }
 
-  void Application::loadModules() {
-    v8::Local<v8::Object> mods   = configparser->getByPath("system/modules", false)->ToObject();
-    v8::Local<v8::String> v8path = configparser->getByPath("system/modpath", false)->ToString();
-    v8::Local<v8::Array>  keys   = mods->GetPropertyNames();
-    v8::Local<v8::Number> num;
-    v8::Local<v8::String> mod;
-    v8::String::Utf8Value path(v8path);
+  std::vector<std::string> Application::moduleList(boost::shared_ptr<Configparser> cfg) {
+    const ConfigValue &mods = cfg->getNode("system/modules", false);
+    std::vector<std::string> names;
 
-    for(int i = 0, len = keys->Length(); i < len; ++i) {
-      num = v8::Number::New(i);
-      mod = mods->Get(num)->ToString();
-      v8::String::Utf8Value mod_utf8(mod);
+    for(size_t i = 0, len = mods.size(); i < len; ++i) {
+      const ConfigValue *mod = mods.at(i);
 
-      loadModule(*path, *mod_utf8);
+      if(mod != NULL && mod->isString()) {
+        names.push_back(mod->asString());
+      }
+    }
+
+    return names;
+  }
+
+  void Application::loadModules() {
+    std::vector<std::string> names = moduleList(configparser);
+    const std::string &path = configparser->getNode("system/modpath", false).asString();
+
+    for(std::vector<std::string>::iterator nam = names.begin(); nam != names.end(); ++nam) {
+      loadModule(path.c_str(), nam->c_str());
     }
 
     std::vector<cf_module_t>::iterator it, end = modules.end();
@@ -152,11 +535,22 @@ namespace CForum {
   }
 
   void Application::registerHook(const std::string &nam, boost::shared_ptr<Controller> cntrl) {
+    pthread_mutex_lock(&stateLock);
     hooks[nam].push_back(cntrl);
+    pthread_mutex_unlock(&stateLock);
   }
 
-  const std::vector<boost::shared_ptr<Controller> > &Application::getHook(const std::string &nam) {
-    return hooks[nam];
+  std::vector<boost::shared_ptr<Controller> > Application::getHook(const std::string &nam) {
+    std::vector<boost::shared_ptr<Controller> > hook;
+
+    pthread_mutex_lock(&stateLock);
+    std::map<std::string, std::vector<boost::shared_ptr<Controller> > >::const_iterator it = hooks.find(nam);
+    if(it != hooks.end()) {
+      hook = it->second;
+    }
+    pthread_mutex_unlock(&stateLock);
+
+    return hook;
   }
 
   void Application::loadModule(const char *path, const char *mod) {
@@ -183,58 +577,306 @@ namespace CForum {
     m.handle = mod_hndl;
     m.controller = cntrl;
 
+    pthread_mutex_lock(&stateLock);
     modules.push_back(m);
+    pthread_mutex_unlock(&stateLock);
+  }
+
+  void Application::setWorkerLimits(unsigned long max_requests, size_t max_rss) {
+    maxRequests = max_requests;
+    maxRss      = max_rss;
+  }
+
+  size_t Application::residentSetSize() {
+    unsigned long size, resident = 0;
+    FILE *fd;
+
+    if((fd = fopen("/proc/self/statm", "r")) != NULL) {
+      if(fscanf(fd, "%lu %lu", &size, &resident) != 2) {
+        resident = 0;
+      }
+
+      fclose(fd);
+      return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) / 1024;
+    }
+
+    /* no procfs; the peak RSS is the best we can get */
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0) {
+      return (size_t)usage.ru_maxrss;
+    }
+
+    return 0;
+  }
+
+  bool Application::workerExhausted() {
+    if(maxRequests > 0 && requestsHandled >= maxRequests) {
+      return true;
+    }
+
+    return maxRss > 0 && residentSetSize() > maxRss;
+  }
+
+  static void appendUrlSuffix(std::string &url, const std::string &method, const std::string &query) {
+    if(!method.empty()) {
+      url += ';';
+      url += method;
+    }
+
+    if(!query.empty()) {
+      url += '?';
+      url += query;
+    }
+  }
+
+  static Router *unwrapRouter(const v8::Arguments &args) {
+    v8::Local<v8::Object> self = args.Holder();
+
+    if(self->InternalFieldCount() < 1) {
+      return NULL;
+    }
+
+    return reinterpret_cast<Router *>(v8::Local<v8::External>::Cast(self->GetInternalField(0))->Value());
+  }
+
+  /* templates hand in the thread and message objects, or just their ids */
+  static std::string urlValue(v8::Local<v8::Value> val) {
+    if(!val.IsEmpty() && val->IsObject()) {
+      val = val->ToObject()->Get(v8::String::NewSymbol("id"));
+    }
+
+    if(val.IsEmpty() || val->IsUndefined() || val->IsNull()) {
+      return std::string();
+    }
+
+    v8::String::Utf8Value str(val);
+    return std::string(*str, str.length());
+  }
+
+  /* absURL(thread[, message[, method[, query]]]) */
+  static v8::Handle<v8::Value> _absURL(const v8::Arguments &args) {
+    Router *rtr = unwrapRouter(args);
+    std::string url, ids[2];
+    size_t count = 1;
+
+    if(rtr == NULL) {
+      return v8::ThrowException(v8::String::New("Oops! Router object is NULL."));
+    }
+
+    if(args.Length() < 1 || args[0].IsEmpty() || !args[0]->BooleanValue()) {
+      return v8::ThrowException(v8::String::New("A thread is needed as first argument!"));
+    }
+
+    ids[0] = urlValue(args[0]);
+
+    if(args.Length() >= 2 && args[1]->BooleanValue()) {
+      ids[1] = urlValue(args[1]);
+      count  = 2;
+    }
+
+    try {
+      rtr->urlFor(url, count == 2 ? "message" : "thread", ids, count);
+    }
+    catch(InternalErrorException &e) {
+      return v8::ThrowException(v8::String::New(e.getMessage().c_str()));
+    }
+
+    appendUrlSuffix(url, args.Length() >= 3 && args[2]->BooleanValue() ? urlValue(args[2]) : "", args.Length() >= 4 && args[3]->BooleanValue() ? urlValue(args[3]) : "");
+
+    return v8::String::New(url.data(), url.length());
+  }
+
+  /* urlFor(name, vars) */
+  static v8::Handle<v8::Value> _urlFor(const v8::Arguments &args) {
+    Router *rtr = unwrapRouter(args);
+    boost::shared_ptr<const UrlTemplate> tpl;
+    std::vector<std::string> values;
+    v8::Local<v8::Object> vars;
+    std::string url;
+    size_t i;
+
+    if(rtr == NULL) {
+      return v8::ThrowException(v8::String::New("Oops! Router object is NULL."));
+    }
+
+    if(args.Length() < 1 || args[0].IsEmpty() || !args[0]->IsString()) {
+      return v8::ThrowException(v8::String::New("A URL name is needed as first argument!"));
+    }
+
+    v8::String::Utf8Value name(args[0]);
+
+    try {
+      tpl = rtr->getUrl(std::string(*name, name.length()));
+    }
+    catch(InternalErrorException &e) {
+      return v8::ThrowException(v8::String::New(e.getMessage().c_str()));
+    }
+
+    const std::vector<std::string> &names = tpl->getNames();
+    values.resize(names.size());
+
+    if(args.Length() >= 2 && !args[1].IsEmpty() && args[1]->IsObject()) {
+      vars = args[1]->ToObject();
+
+      for(i = 0; i < names.size(); ++i) {
+        values[i] = urlValue(vars->Get(v8::String::New(names[i].data(), names[i].length())));
+      }
+    }
+
+    url = rtr->getBaseURL();
+    tpl->expand(url, values.empty() ? NULL : &values[0], values.size());
+
+    return v8::String::New(url.data(), url.length());
+  }
+
+  static v8::Local<v8::ObjectTemplate> createRouterTemplate() {
+    v8::Local<v8::ObjectTemplate> templ = v8::ObjectTemplate::New();
+
+    templ->SetInternalFieldCount(1);
+    templ->Set(v8::String::New("absURL"), v8::FunctionTemplate::New(_absURL));
+    templ->Set(v8::String::New("urlFor"), v8::FunctionTemplate::New(_urlFor));
+
+    return templ;
+  }
+
+  /* templates belong to an isolate, so each thread builds its own once */
+  static v8::Handle<v8::ObjectTemplate> isolateTemplate(v8::Persistent<v8::ObjectTemplate> &templ, v8::Local<v8::ObjectTemplate> (*create)()) {
+    if(templ.IsEmpty()) {
+      v8::HandleScope scope;
+      templ = v8::Persistent<v8::ObjectTemplate>::New(create());
+    }
+
+    return templ;
+  }
+
+  v8::Handle<v8::ObjectTemplate> Application::getRouterTemplate() {
+    WorkerState *state = getWorkerState();
+    return isolateTemplate(state ? state->routerTemplate : routerTemplate, createRouterTemplate);
+  }
+
+  v8::Handle<v8::ObjectTemplate> Application::getConfigparserTemplate() {
+    WorkerState *state = getWorkerState();
+    return isolateTemplate(state ? state->configparserTemplate : configparserTemplate, Request::createConfigparserTemplate);
+  }
+
+  ConfigValueCache *Application::getConfigValueCache() {
+    WorkerState *state = getWorkerState();
+    boost::shared_ptr<ConfigValueCache> &cache = state ? state->configCache : configCache;
+
+    if(!cache) {
+      cache = boost::make_shared<ConfigValueCache>();
+    }
+
+    return cache.get();
+  }
+
+  /* the router lives as long as the request rendering with it */
+  static v8::Local<v8::Object> routerObject(v8::Handle<v8::ObjectTemplate> templ, Router *rtr) {
+    v8::Local<v8::Object> obj = templ->NewInstance();
+    obj->SetInternalField(0, v8::External::New(rtr));
+
+    return obj;
   }
 
   void Application::run(boost::shared_ptr<Request> rq) {
-    std::vector<cf_module_t>::iterator it, end = modules.end();
+    boost::shared_ptr<Configparser> cfg;
+    boost::shared_ptr<Router> rtr;
+    std::vector<cf_module_t> mods;
+    std::string views;
 
-    v8::String::Utf8Value path(configparser->getByPath("system/views", false)->ToString());
-    rq->initTemplate(configparser);
-    rq->getTemplate()->setBaseDir(*path);
+    __sync_add_and_fetch(&requestsHandled, 1);
 
-    for(it = modules.begin(); it != end; ++it) {
+    /* a reload during this request must not change what it runs with */
+    pthread_mutex_lock(&stateLock);
+    cfg   = configparser;
+    rtr   = router;
+    mods  = modules;
+    views = viewsDir;
+    pthread_mutex_unlock(&stateLock);
+
+    std::vector<cf_module_t>::iterator it, end = mods.end();
+
+    rq->initTemplate(cfg, getTemplatePool(), getConfigparserTemplate(), getConfigValueCache());
+    rq->getTemplate()->setBaseDir(views);
+    rq->getTemplate()->setGlobal("router", routerObject(getRouterTemplate(), rtr.get()));
+
+    for(it = mods.begin(); it != end; ++it) {
       it->controller->preRoute(rq);
     }
 
-    std::string retval = router->dispatch(rq);
+    /* modules had their say about the user, now we know whether the page can be shared */
+    std::string cache_key = responseCache->keyFor(rq);
+    unsigned long generation = configGeneration, epoch = responseCache->getEpoch();
+    boost::shared_ptr<const ResponseCache::Entry> cached;
+    boost::shared_ptr<std::string> rendered;
+    std::string retval;
 
-    for(it = modules.begin(); it != end; ++it) {
+    if(!cache_key.empty() && !(cached = responseCache->lookup(cache_key, generation))) {
+      rendered = boost::make_shared<std::string>();
+      rq->captureBody(rendered);
+    }
+
+    if(!cached) {
+      retval = rtr->dispatch(rq);
+    }
+
+    for(it = mods.begin(); it != end; ++it) {
       it->controller->postRoute(rq);
     }
 
+    if(cached) {
+      responseCache->replay(cached, rq);
+      return;
+    }
+
     rq->output(retval);
+
+    if(rendered) {
+      rq->captureBody(boost::shared_ptr<std::string>());
+      responseCache->store(cache_key, rq, *rendered, generation, epoch);
+    }
   }
 
 
   std::string Application::absURL(const Models::Thread &t, const std::string &method, const std::string &query) {
-    std::string url = *v8::String::Utf8Value(configparser->getByPath("system/urls/base", false)->ToString());
-    url += t.id;
-    if(!method.empty()) {
-      url += ";" + method;
-    }
-    if(!query.empty()) {
-      url += "?" + query;
-    }
+    std::string url;
+
+    getRouter()->urlFor(url, "thread", &t.id, 1);
+    appendUrlSuffix(url, method, query);
 
     return url;
   }
 
   std::string Application::absURL(const Models::Thread &t, const Models::Message &m, const std::string &method, const std::string &query) {
-    std::string url = *v8::String::Utf8Value(configparser->getByPath("system/urls/base", false)->ToString());
-    url += t.id + "/" + m.id;
+    std::string url, ids[2] = { t.id, m.id };
 
-    if(!method.empty()) {
-      url += ";" + method;
-    }
-    if(!query.empty()) {
-      url += "?" + query;
-    }
+    getRouter()->urlFor(url, "message", ids, 2);
+    appendUrlSuffix(url, method, query);
 
     return url;
   }
 
-  Application::~Application() { }
+  void Application::threadChanged(boost::shared_ptr<Request> rq, const Models::Thread &t) {
+    Models::Thread::touch(getMongo(), t.id);
+    notificationCenter->notify(NOTIFY_THREAD_CHANGED, rq, (void *)&t);
+  }
+
+  void Application::messageChanged(boost::shared_ptr<Request> rq, const Models::Thread &t, const Models::Message &m) {
+    Models::Thread::touch(getMongo(), t.id);
+    notificationCenter->notify(NOTIFY_MESSAGE_CHANGED, rq, (void *)&m);
+  }
+
+  Application::~Application() {
+    if(!routerTemplate.IsEmpty()) {
+      routerTemplate.Dispose();
+    }
+
+    if(!configparserTemplate.IsEmpty()) {
+      configparserTemplate.Dispose();
+    }
+
+    pthread_mutex_destroy(&stateLock);
+  }
 
 }
 
@@ -36,8 +36,18 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 
+#include <cstdio>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
 #include <unistd.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 
 #include "framework/mongodb.hh"
 
@@ -46,6 +56,13 @@
 #include "framework/notification_center.hh"
 
 #include "framework/router.hh"
+#include "framework/config_watcher.hh"
+#include "framework/response_compressor.hh"
+#include "framework/response_cache.hh"
+
+#include "cgi/body_parser.hh"
+
+#include "template/template_pool.hh"
 
 #include "framework/module_exception.hh"
 
@@ -64,6 +81,26 @@ namespace CForum {
   class Application {
   public:
     static const char *NOTIFY_PRE_RUN;
+    static const char *NOTIFY_THREAD_CHANGED;
+    static const char *NOTIFY_MESSAGE_CHANGED;
+
+    /**
+     * What a worker thread can't share with the others: V8 values can't
+     * cross isolates and a database connection serves one request at a
+     * time; the configuration is shared by all of them
+     */
+    class WorkerState {
+    public:
+      WorkerState();
+      ~WorkerState();
+
+      boost::shared_ptr<JSEvaluator> evaluator;
+      boost::shared_ptr<DBClientConnection> mongodb;
+      boost::shared_ptr<TemplatePool> templatePool;
+      v8::Persistent<v8::ObjectTemplate> routerTemplate;
+      v8::Persistent<v8::ObjectTemplate> configparserTemplate;
+      boost::shared_ptr<ConfigValueCache> configCache;
+    };
 
     Application();
     virtual ~Application();
@@ -72,34 +109,108 @@ namespace CForum {
     virtual boost::shared_ptr<Router> getRouter();
     virtual boost::shared_ptr<NotificationCenter> getNotificationCenter();
     virtual boost::shared_ptr<DBClientConnection> getMongo();
+    boost::shared_ptr<ResponseCache> getResponseCache();
+
+    virtual const std::string &getListenAddress() const;
+
+    std::string getViewsDir();
+    std::string getBaseURL();
 
     virtual void init();
     virtual void init(int argc, char *[]);
+    virtual void configure();
+    virtual void initWorker();
     virtual void scanArgs(int, char *[]);
     virtual void loadModules();
+    virtual void loadExtensions();
+
+    virtual void watchConfig();
+    virtual void stopWatchingConfig();
+    virtual bool reloadPending();
+    virtual bool waitForReload(int);
+    virtual bool reload();
+    virtual bool checkReload();
+    unsigned long getConfigGeneration() const;
+
+    virtual v8::ExtensionConfiguration *getExtensionConfiguration();
+    virtual boost::shared_ptr<TemplatePool> getTemplatePool();
 
     virtual void handleRequest() = 0;
     virtual void run(boost::shared_ptr<Request>);
 
-    virtual const std::vector<boost::shared_ptr<Controller> > &getHook(const std::string &);
+    virtual void setWorkerLimits(unsigned long, size_t);
+    virtual bool workerExhausted();
+    unsigned long getRequestsHandled() const;
+
+    static size_t residentSetSize();
+
+    virtual std::vector<boost::shared_ptr<Controller> > getHook(const std::string &);
     virtual void registerHook(const std::string &, boost::shared_ptr<Controller>);
 
     virtual std::string absURL(const Models::Thread &, const std::string & = "", const std::string & = "");
     virtual std::string absURL(const Models::Thread &, const Models::Message &, const std::string & = "", const std::string & = "");
 
+    /**
+     * Every write to a thread or a message ends here: bumps the version
+     * stamps and posts NOTIFY_THREAD_CHANGED or NOTIFY_MESSAGE_CHANGED,
+     * so the response cache drops what it rendered from the old state
+     */
+    virtual void threadChanged(boost::shared_ptr<Request>, const Models::Thread &);
+    virtual void messageChanged(boost::shared_ptr<Request>, const Models::Thread &, const Models::Message &);
+
   protected:
     virtual void loadModule(const char *, const char *);
+    virtual std::vector<std::string> moduleList(boost::shared_ptr<Configparser>);
+    virtual void validateConfig(boost::shared_ptr<Configparser>);
+    virtual void applySettings(boost::shared_ptr<Configparser>);
+    virtual void setupUrls(boost::shared_ptr<Router>, const std::string &);
+
+    virtual void connectMongo(boost::shared_ptr<Configparser>, boost::shared_ptr<DBClientConnection>);
+    virtual boost::shared_ptr<WorkerState> createWorkerState();
+
+    static void setWorkerState(WorkerState *);
+    static WorkerState *getWorkerState();
+
+    v8::Handle<v8::ObjectTemplate> getRouterTemplate();
+    v8::Handle<v8::ObjectTemplate> getConfigparserTemplate();
+    ConfigValueCache *getConfigValueCache();
+
+    /* the context the main thread works in; templates bring their own */
+    JSEvaluator evaluator;
 
     boost::shared_ptr<DBClientConnection> mongodb;
 
     boost::shared_ptr<Configparser> configparser;
     boost::shared_ptr<Router> router;
     boost::shared_ptr<NotificationCenter> notificationCenter;
+    boost::shared_ptr<ResponseCache> responseCache;
 
     std::vector<cf_module_t> modules;
     std::map<std::string, std::vector<boost::shared_ptr<Controller> > > hooks;
 
     std::string configfile;
+    std::string viewsDir, baseURL;
+
+    std::vector<std::string> extensionNames, extensionSources;
+    std::vector<const char *> extensionNamePointers;
+    boost::shared_ptr<v8::ExtensionConfiguration> extensionConfiguration;
+    boost::shared_ptr<TemplatePool> templatePool;
+    v8::Persistent<v8::ObjectTemplate> routerTemplate;
+    v8::Persistent<v8::ObjectTemplate> configparserTemplate;
+    boost::shared_ptr<ConfigValueCache> configCache;
+    std::string listenAddress;
+
+    /*
+     * guards configparser, router, modules, hooks, viewsDir and baseURL
+     * against a concurrent reload; recursive since modules register their
+     * routes and hooks while a reload holds it
+     */
+    pthread_mutex_t stateLock;
+    ConfigWatcher configWatcher;
+    volatile unsigned long configGeneration;
+
+    unsigned long requestsHandled, maxRequests;
+    size_t maxRss;
 
   private:
     Application(const Application &);
@@ -107,20 +218,28 @@ namespace CForum {
   };
 
 
-  inline boost::shared_ptr<Configparser> Application::getConfigparser() {
-    return configparser;
+  inline boost::shared_ptr<NotificationCenter> Application::getNotificationCenter() {
+    return notificationCenter;
   }
 
-  inline boost::shared_ptr<Router> Application::getRouter() {
-    return router;
+  inline boost::shared_ptr<ResponseCache> Application::getResponseCache() {
+    return responseCache;
   }
 
-  inline boost::shared_ptr<NotificationCenter> Application::getNotificationCenter() {
-    return notificationCenter;
+  inline v8::ExtensionConfiguration *Application::getExtensionConfiguration() {
+    return extensionConfiguration.get();
+  }
+
+  inline const std::string &Application::getListenAddress() const {
+    return listenAddress;
+  }
+
+  inline unsigned long Application::getConfigGeneration() const {
+    return configGeneration;
   }
 
-  inline boost::shared_ptr<DBClientConnection> Application::getMongo() {
-    return mongodb;
+  inline unsigned long Application::getRequestsHandled() const {
+    return requestsHandled;
   }
 
 
@@ -34,7 +34,18 @@ namespace CForum {
   CGIApplication::CGIApplication() : Application(), request(boost::make_shared<CGIRequest>()) { }
 
   void CGIApplication::handleRequest() {
-    run(request);
+    try {
+      run(request);
+    }
+    catch(CForumException &e) {
+      /* we can't send an error page in the middle of a streamed one */
+      if(!request->isCommitted()) {
+        throw;
+      }
+
+      std::cerr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      request->finish();
+    }
   }
 
   CGIApplication::~CGIApplication() { }
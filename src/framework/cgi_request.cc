@@ -32,11 +32,22 @@
 
 namespace CForum {
   CGIRequest::CGIRequest() : Request::Request(), cgi(CGI::fromCGIEnvironment()) {
+    initUri();
+  }
+
+  CGIRequest::CGIRequest(const CGI &c) : Request::Request(), cgi(c) {
+    initUri();
+  }
+
+  void CGIRequest::initUri() {
     std::string path_info = cgi.pathInfo(),
       hostname = cgi.serverName(),
-      https = cgi.getCGIVariable("HTTPS");
+      https = cgi.getCGIVariable("HTTPS"),
+      query = cgi.getCGIVariable("QUERY_STRING");
 
-    std::stringstream uri_s;
+    /* written straight into the URI's own buffer and parsed in place */
+    std::string &uri_s = requestUri.buffer();
+    char port_s[16];
 
     int port = cgi.serverPort();
 
@@ -44,23 +55,41 @@ namespace CForum {
       hostname = "localhost";
     }
 
-    uri_s << (https.length() == 0 ? "http://" : "https://") << hostname;
-    if(port != 0 && ((https.length() != 0 && port != 443) || port != 80)) {
-      uri_s << ":" << port;
+    uri_s.clear();
+    uri_s.reserve(hostname.length() + path_info.length() + query.length() + 32);
+
+    uri_s += https.length() == 0 ? "http://" : "https://";
+    uri_s += hostname;
+
+    if(port != 0 && ((https.length() != 0 && port != 443) || (https.length() == 0 && port != 80))) {
+      snprintf(port_s, sizeof(port_s), ":%d", port);
+      uri_s += port_s;
+    }
+
+    if(path_info.length()) {
+      uri_s += path_info;
+    }
+    else {
+      uri_s += '/';
     }
 
-    uri_s << (path_info.length() ? path_info : "/");
+    if(!query.empty()) {
+      uri_s += '?';
+      uri_s += query;
+    }
 
-    requestUri = URI(uri_s.str());
+    requestUri.parse();
+    requestMethod = cgi.requestMethod();
   }
 
   CGIRequest::CGIRequest(const CGIRequest &rq) : Request::Request(rq), cgi(rq.cgi) { }
 
   CGIRequest &CGIRequest::operator=(const CGIRequest &rq) {
     if(this != &rq) {
-      requestUri = rq.requestUri;
-      user       = rq.user;
-      cgi        = rq.cgi;
+      requestUri    = rq.requestUri;
+      requestMethod = rq.requestMethod;
+      user          = rq.user;
+      cgi           = rq.cgi;
     }
 
     return *this;
@@ -72,31 +101,221 @@ namespace CForum {
     return (i != std::string::npos) && (i == (str.length() - substr.length()));
   }
   void CGIRequest::output(const std::string &body) {
-    std::unordered_map<std::string, std::string>::iterator it, end = headers.end();
+    /* whatever the controllers returned follows what they streamed */
+    if(committed) {
+      getOutputStream().write(body.data(), body.length());
+    }
+    else {
+      const char *data = body.data();
+      size_t len = body.length();
+      std::string packed;
+
+      if(capture) {
+        capture->append(data, len);
+      }
+
+      selectEncoding();
+
+      /* small bodies don't get any smaller */
+      if(compressor && len < compression->minLength && immutableKey.empty()) {
+        compressor.reset();
+        headers.erase("Content-Encoding");
+      }
+
+      if(compressor) {
+        compressBody(data, len, true, packed);
+        data = packed.data();
+        len  = packed.length();
+      }
+
+      contentLength = (long)len;
+      commit();
+      sendBody(data, len);
+    }
+
+    finish();
+  }
+
+  void CGIRequest::selectEncoding() {
+    const std::string *type;
+    ResponseCompressor::Encoding enc;
+
+    if(encodingSelected) {
+      return;
+    }
+
+    encodingSelected = true;
+
+    if(compression->level == 0 || findHeader("Content-Encoding") != NULL) {
+      return;
+    }
+
+    /* responses without a body must stay without one */
+    if(isBodyless()) {
+      return;
+    }
+
+    if((type = findHeader("Content-Type")) != NULL && !ResponseCompressor::isCompressible(*type)) {
+      return;
+    }
+
+    headers["Vary"] = "Accept-Encoding";
+
+    if((enc = ResponseCompressor::negotiate(cgi.getHeader("Accept-Encoding"))) == ResponseCompressor::EncodingIdentity) {
+      return;
+    }
+
+    compressor = boost::make_shared<ResponseCompressor>(enc, compression->level);
+
+    if(compressor->isFinished()) {
+      compressor.reset();
+      return;
+    }
+
+    headers["Content-Encoding"] = ResponseCompressor::encodingName(enc);
+  }
+
+  static const char HTTPDateFormat[] = "%a, %d %b %Y %H:%M:%S GMT";
+
+  static std::string formatHTTPDate(time_t tm) {
+    struct tm t;
+    char buff[64];
+
+    gmtime_r(&tm, &t);
+    return std::string(buff, strftime(buff, sizeof(buff), HTTPDateFormat, &t));
+  }
+
+  /* only the IMF-fixdate; anything else is ignored and gets a full response */
+  static time_t parseHTTPDate(const std::string &str) {
+    struct tm t;
+
+    memset(&t, 0, sizeof(t));
+
+    if(strptime(str.c_str(), HTTPDateFormat, &t) == NULL) {
+      return (time_t)-1;
+    }
+
+    return timegm(&t);
+  }
+
+  /* weak comparison (RFC 7232, 2.3.2): the W/ prefix doesn't matter for GET */
+  static bool etagMatches(const std::string &list, const std::string &etag) {
+    std::string wanted = etag.compare(0, 2, "W/") == 0 ? etag.substr(2) : etag;
+    size_t pos = 0, end, len = list.length();
+
+    while(pos < len) {
+      while(pos < len && (list[pos] == ' ' || list[pos] == '\t' || list[pos] == ',')) {
+        ++pos;
+      }
+
+      if(pos >= len) {
+        break;
+      }
+
+      if(list[pos] == '*') {
+        return true;
+      }
+
+      if(list.compare(pos, 2, "W/") == 0) {
+        pos += 2;
+      }
+
+      if(pos < len && list[pos] == '"') {
+        end = list.find('"', pos + 1);
+        end = end == std::string::npos ? len : end + 1;
+      }
+      else {
+        end = list.find(',', pos);
+        end = end == std::string::npos ? len : end;
+      }
+
+      if(list.compare(pos, end - pos, wanted) == 0) {
+        return true;
+      }
+
+      pos = end;
+    }
+
+    return false;
+  }
+
+  bool CGIRequest::notModified(const std::string &tag, time_t modified) {
+    std::string method = cgi.requestMethod(), inm = cgi.getHeader("If-None-Match"), ims = cgi.getHeader("If-Modified-Since");
+    bool match = false;
+    time_t since;
+
+    etag         = tag;
+    lastModified = modified;
+
+    if(!tag.empty()) {
+      setHeader("ETag", tag);
+    }
+    if(modified > 0) {
+      setHeader("Last-Modified", formatHTTPDate(modified));
+    }
+
+    if(method != "GET" && method != "HEAD") {
+      return false;
+    }
+
+    /* If-Modified-Since only counts if there is no If-None-Match (RFC 7232, 6) */
+    if(!inm.empty()) {
+      match = !tag.empty() && etagMatches(inm, tag);
+    }
+    else if(!ims.empty() && modified > 0) {
+      match = (since = parseHTTPDate(ims)) != (time_t)-1 && modified <= since;
+    }
+
+    if(match) {
+      headers["Status"] = "304 Not Modified";
+      output(std::string());
+    }
+
+    return match;
+  }
+
+  void CGIRequest::sendHeaders() {
+    std::unordered_map<std::string, std::string>::const_iterator it, end = headers.end();
     bool had_ct = false;
 
+    /* the header map can't change any more, so its strings are referenced, not copied */
     for(it = headers.begin(); it != end; ++it) {
-      std::string nam = it->first;
-      std::transform(nam.begin(), nam.end(), nam.begin(), tolower);
-
-      if(nam == "content-type") {
+      if(strcasecmp(it->first.c_str(), "content-type") == 0) {
         had_ct = true;
       }
 
-      std::cout << it->first << ": " << it->second;
+      response.add(it->first);
+      response.add(": ", 2);
+      response.add(it->second);
 
       if(!endsWith(it->second, "\012")) {
-        std::cout << "\015\012";
+        response.add("\015\012", 2);
       }
     }
 
     if(!had_ct) {
-      std::cout << "Content-Type: text/html; charset=utf-8\015\012";
+      response.add("Content-Type: text/html; charset=utf-8\015\012");
     }
 
-    std::cout << "\015\012";
+    response.add("\015\012", 2);
+  }
+
+  /* the body segment only lives until we return, so the headers go out with the first one */
+  void CGIRequest::sendBody(const char *buff, size_t len) {
+    response.add(buff, len);
+    writeResponse();
+  }
+
+  void CGIRequest::endBody() {
+    writeResponse();
+  }
+
+  void CGIRequest::writeResponse() {
+    /* don't overtake anything written through std::cout */
+    std::cout.flush();
 
-    std::cout << body;
+    response.writeTo(STDOUT_FILENO);
+    response.clear();
   }
 
   CGIRequest::~CGIRequest() { }
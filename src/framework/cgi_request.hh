@@ -35,15 +35,17 @@
 #include <string>
 #include <sstream>
 
-#include <algorithm>
-#include <cctype>
+#include <cstring>
+#include <strings.h>
 
 #include "framework/request.hh"
+#include "framework/response_writer.hh"
 
 namespace CForum {
   class CGIRequest : public Request {
   public:
     CGIRequest();
+    CGIRequest(const CGI &);
     CGIRequest(const CGIRequest &);
     virtual ~CGIRequest();
 
@@ -52,9 +54,19 @@ namespace CForum {
     virtual const CGI &getCGI() const;
 
     virtual void output(const std::string &);
+    virtual bool notModified(const std::string &, time_t);
 
   protected:
+    virtual void initUri();
+    virtual void writeResponse();
+
+    virtual void sendHeaders();
+    virtual void sendBody(const char *, size_t);
+    virtual void endBody();
+    virtual void selectEncoding();
+
     CGI cgi;
+    ResponseWriter response;
 
   };
 
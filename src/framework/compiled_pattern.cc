@@ -0,0 +1,189 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Compiled route pattern implementation
+ * \package framework
+ *
+ * A route regex compiled and studied once (JIT compiled when PCRE can do
+ * it) and shared between all copies of a route pattern
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/compiled_pattern.hh"
+
+namespace CForum {
+  CompiledPattern::CompiledPattern(const std::string &pattern) : regex(NULL), extra(NULL), captures(0), leading(), anchored(false) {
+    const char *error = NULL;
+    int offset = 0, flags = 0;
+
+    if((regex = pcre_compile(pattern.c_str(), 0, &error, &offset, NULL)) == NULL) {
+      throw RouteSyntaxException(std::string("Error: pattern does not compile: ") + (error ? error : "unknown error"), RouteSyntaxException::PatternCompileError);
+    }
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+    flags = PCRE_STUDY_JIT_COMPILE;
+#endif
+
+    /* a NULL result without an error just means there was nothing to learn */
+    extra = pcre_study(regex, flags, &error);
+
+    pcre_fullinfo(regex, extra, PCRE_INFO_CAPTURECOUNT, &captures);
+
+    leading = leadingText(pattern, anchored);
+  }
+
+  CompiledPattern::~CompiledPattern() {
+    if(extra) {
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pcre_free_study(extra);
+#else
+      pcre_free(extra);
+#endif
+    }
+
+    pcre_free(regex);
+  }
+
+  /*
+   * Nothing in here is modified after construction, so any number of
+   * threads may match at the same time; the caller brings the ovector
+   */
+  int CompiledPattern::match(const char *subject, size_t len, int *ovector, int size) const {
+    int rc;
+
+    if(!mayMatch(subject, len)) {
+      return 0;
+    }
+
+    if((rc = pcre_exec(regex, extra, subject, (int)len, 0, 0, ovector, size)) < 0) {
+      return 0;
+    }
+
+    /* 0 means the ovector was too small but the pattern did match */
+    return rc == 0 ? size / 3 : rc;
+  }
+
+  /*
+   * The fixed text a pattern starts with, e.g. "/thread/" for
+   * "^/thread/(\\d+)$"; empty when the pattern has an alternative at
+   * the top level. anchored tells if the text has to be at the start
+   */
+  std::string CompiledPattern::leadingText(const std::string &pattern, bool &anchored) {
+    std::string prefix;
+    size_t i, start, depth = 0, len = pattern.length();
+    bool inClass = false;
+    char c, next;
+
+    anchored = len > 0 && pattern[0] == '^';
+    start    = anchored ? 1 : 0;
+
+    for(i = start; i < len; ++i) {
+      switch(pattern[i]) {
+        case '\\':
+          ++i;
+          break;
+
+        case '[':
+          if(!inClass) {
+            inClass = true;
+
+            /* a ] right at the start is a literal */
+            if(i + 1 < len && pattern[i + 1] == '^') {
+              ++i;
+            }
+            if(i + 1 < len && pattern[i + 1] == ']') {
+              ++i;
+            }
+          }
+          break;
+
+        case ']':
+          inClass = false;
+          break;
+
+        case '(':
+          if(!inClass) {
+            ++depth;
+          }
+          break;
+
+        case ')':
+          if(!inClass && depth > 0) {
+            --depth;
+          }
+          break;
+
+        case '|':
+          if(!inClass && depth == 0) {
+            anchored = false;
+            return prefix;
+          }
+          break;
+      }
+    }
+
+    for(i = start; i < len; ++i) {
+      c = pattern[i];
+
+      if(c == '\\') {
+        /* \d, \w, \b and friends are no literals */
+        if(i + 1 >= len || isalnum((unsigned char)pattern[i + 1])) {
+          break;
+        }
+
+        c = pattern[++i];
+      }
+      else if(strchr(".[](){}*+?|^$", c) != NULL) {
+        break;
+      }
+
+      next = i + 1 < len ? pattern[i + 1] : '\0';
+
+      /* an optional character ends the prefix before it, with all its UTF-8 bytes */
+      if(next == '*' || next == '?' || next == '{') {
+        if(((unsigned char)c & 0xC0) == 0x80) {
+          while(!prefix.empty() && ((unsigned char)prefix[prefix.length() - 1] & 0xC0) == 0x80) {
+            prefix.erase(prefix.length() - 1);
+          }
+
+          if(!prefix.empty()) {
+            prefix.erase(prefix.length() - 1);
+          }
+        }
+
+        break;
+      }
+
+      prefix += c;
+
+      if(next == '+') {
+        break;
+      }
+    }
+
+    return prefix;
+  }
+
+}
+
+/* eof */
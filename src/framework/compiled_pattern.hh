@@ -0,0 +1,104 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Compiled route pattern interface
+ * \package framework
+ *
+ * A route regex compiled and studied once (JIT compiled when PCRE can do
+ * it) and shared between all copies of a route pattern
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef COMPILED_PATTERN_H
+#define COMPILED_PATTERN_H
+
+#include <string>
+#include <cstring>
+#include <cctype>
+
+#include <pcre.h>
+
+#include "framework/route_syntax_exception.hh"
+
+namespace CForum {
+  class CompiledPattern {
+  public:
+    CompiledPattern(const std::string &);
+    ~CompiledPattern();
+
+    int match(const char *, size_t, int *, int) const;
+    bool mayMatch(const char *, size_t) const;
+
+    int getCaptureCount() const;
+
+    const std::string &getLeadingText() const;
+    bool isAnchored() const;
+
+    static std::string leadingText(const std::string &, bool &);
+
+  private:
+    CompiledPattern(const CompiledPattern &);
+    CompiledPattern &operator=(const CompiledPattern &);
+
+    pcre *regex;
+    pcre_extra *extra;
+    int captures;
+
+    std::string leading;
+    bool anchored;
+  };
+
+  inline int CompiledPattern::getCaptureCount() const {
+    return captures;
+  }
+
+  inline const std::string &CompiledPattern::getLeadingText() const {
+    return leading;
+  }
+
+  inline bool CompiledPattern::isAnchored() const {
+    return anchored;
+  }
+
+  /* cheap test before we enter PCRE: the fixed text has to be there */
+  inline bool CompiledPattern::mayMatch(const char *subject, size_t len) const {
+    if(leading.empty()) {
+      return true;
+    }
+
+    if(len < leading.length()) {
+      return false;
+    }
+
+    if(anchored) {
+      return memcmp(subject, leading.data(), leading.length()) == 0;
+    }
+
+    return memmem(subject, len, leading.data(), leading.length()) != NULL;
+  }
+
+}
+
+#endif
+
+/* eof */
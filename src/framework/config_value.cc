@@ -0,0 +1,262 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Config value implementation; native snapshot of the evaluated configuration
+ * \package framework
+ *
+ * A config value is a node of the native, immutable copy of the evaluated
+ * configuration, so that reading config values doesn't need V8 lookups
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/config_value.hh"
+
+namespace CForum {
+  ConfigValue::ConfigValue() : _type(TypeNull), _bool(false), _number(0), _string(), _array(), _object() { }
+
+  ConfigValue ConfigValue::fromV8(v8::Handle<v8::Value> val, int depth) {
+    v8::HandleScope scope;
+    ConfigValue cv;
+
+    /* cyclic structures make no sense in a config file; cut them off */
+    if(val.IsEmpty() || val->IsNull() || val->IsUndefined() || val->IsFunction() || depth > 32) {
+      return cv;
+    }
+
+    if(val->IsBoolean() || val->IsBooleanObject()) {
+      cv._type = TypeBool;
+      cv._bool = val->BooleanValue();
+      cv._number = cv._bool ? 1 : 0;
+    }
+    else if(val->IsNumber() || val->IsNumberObject()) {
+      cv._type   = TypeNumber;
+      cv._number = val->NumberValue();
+      cv._bool   = cv._number != 0;
+    }
+    else if(val->IsString() || val->IsStringObject()) {
+      cv._type   = TypeString;
+      cv._string = *v8::String::Utf8Value(val);
+      cv._number = strtod(cv._string.c_str(), NULL);
+      cv._bool   = !cv._string.empty();
+    }
+    else if(val->IsArray()) {
+      v8::Handle<v8::Array> ary = v8::Handle<v8::Array>::Cast(val);
+      cv._type = TypeArray;
+      cv._bool = true;
+
+      for(uint32_t i = 0; i < ary->Length(); ++i) {
+        cv._array.push_back(fromV8(ary->Get(i), depth + 1));
+      }
+    }
+    else if(val->IsObject()) {
+      v8::Local<v8::Object> obj = val->ToObject();
+      v8::Local<v8::Array> keys = obj->GetPropertyNames();
+      cv._type = TypeObject;
+      cv._bool = true;
+
+      for(uint32_t i = 0; i < keys->Length(); ++i) {
+        v8::Local<v8::Value> key = keys->Get(i);
+        cv._object.push_back(std::make_pair(std::string(*v8::String::Utf8Value(key)), fromV8(obj->Get(key), depth + 1)));
+      }
+    }
+    else {
+      cv._type   = TypeString;
+      cv._string = *v8::String::Utf8Value(val);
+      cv._bool   = !cv._string.empty();
+    }
+
+    return cv;
+  }
+
+  /* a fresh copy in the current context; every isolate can have its own */
+  v8::Local<v8::Value> ConfigValue::toV8(ConfigValueCache *cache) const {
+    v8::HandleScope scope;
+    v8::Local<v8::Value> val;
+    uint32_t i;
+
+    if(cache && (_type == TypeNumber || _type == TypeString)) {
+      return scope.Close(cache->getPrimitive(*this));
+    }
+
+    switch(_type) {
+    case TypeBool:
+      val = v8::Local<v8::Value>::New(v8::Boolean::New(_bool));
+      break;
+
+    case TypeNumber:
+      val = v8::Number::New(_number);
+      break;
+
+    case TypeString:
+      val = v8::String::New(_string.data(), _string.length());
+      break;
+
+    case TypeArray: {
+      v8::Local<v8::Array> ary = v8::Array::New((int)_array.size());
+
+      for(i = 0; i < _array.size(); ++i) {
+        ary->Set(i, _array[i].toV8(cache));
+      }
+
+      val = ary;
+      break;
+    }
+
+    case TypeObject: {
+      v8::Local<v8::Object> obj = v8::Object::New();
+      ObjectType::const_iterator it, end = _object.end();
+
+      for(it = _object.begin(); it != end; ++it) {
+        obj->Set(v8::String::New(it->first.data(), it->first.length()), it->second.toV8(cache));
+      }
+
+      val = obj;
+      break;
+    }
+
+    default:
+      val = v8::Local<v8::Value>::New(v8::Null());
+      break;
+    }
+
+    return scope.Close(val);
+  }
+
+  const ConfigValue *ConfigValue::get(const char *key, size_t len) const {
+    ObjectType::const_iterator it, end = _object.end();
+
+    if(_type != TypeObject) {
+      return NULL;
+    }
+
+    /* config objects are small; a linear scan beats hashing here */
+    for(it = _object.begin(); it != end; ++it) {
+      if(it->first.length() == len && memcmp(it->first.data(), key, len) == 0) {
+        return &it->second;
+      }
+    }
+
+    return NULL;
+  }
+
+  /* segments are compared where they are, reading a value allocates nothing */
+  const ConfigValue *ConfigValue::getByPath(const std::string &path) const {
+    const ConfigValue *cur = this;
+    const char *str = path.data();
+    size_t start = 0, end, len = path.length(), i, idx;
+
+    while(start < len && str[start] == '/') {
+      ++start;
+    }
+
+    while(cur != NULL && start < len) {
+      for(end = start; end < len && str[end] != '/'; ++end) ;
+
+      if(end > start) {
+        if(cur->_type == TypeArray) {
+          for(i = start, idx = 0; i < end && str[i] >= '0' && str[i] <= '9'; ++i) {
+            idx = idx * 10 + (size_t)(str[i] - '0');
+          }
+
+          cur = i == end ? cur->at(idx) : NULL;
+        }
+        else {
+          cur = cur->get(str + start, end - start);
+        }
+      }
+
+      start = end + 1;
+    }
+
+    return cur;
+  }
+
+  bool ConfigValue::operator==(const ConfigValue &other) const {
+    if(_type != other._type) {
+      return false;
+    }
+
+    switch(_type) {
+    case TypeBool:
+      return _bool == other._bool;
+
+    case TypeNumber:
+      return _number == other._number;
+
+    case TypeString:
+      return _string == other._string;
+
+    case TypeArray:
+      return _array == other._array;
+
+    case TypeObject:
+      return _object == other._object;
+
+    default:
+      return true;
+    }
+  }
+
+  ConfigValueCache::ConfigValueCache() : snapshot(), values() { }
+
+  /* the snapshot changes with a reload; values of the old one are dropped then */
+  v8::Local<v8::Value> ConfigValueCache::get(boost::shared_ptr<const ConfigValue> snap, const ConfigValue &val) {
+    if(snap != snapshot) {
+      clear();
+      snapshot = snap;
+    }
+
+    return val.toV8(this);
+  }
+
+  v8::Local<v8::Value> ConfigValueCache::getPrimitive(const ConfigValue &val) {
+    std::unordered_map<const ConfigValue *, v8::Persistent<v8::Value> >::iterator it = values.find(&val);
+
+    if(it != values.end()) {
+      return v8::Local<v8::Value>::New(it->second);
+    }
+
+    v8::Local<v8::Value> v8val = val.toV8();
+    values[&val] = v8::Persistent<v8::Value>::New(v8val);
+
+    return v8val;
+  }
+
+  void ConfigValueCache::clear() {
+    std::unordered_map<const ConfigValue *, v8::Persistent<v8::Value> >::iterator it, end = values.end();
+
+    for(it = values.begin(); it != end; ++it) {
+      it->second.Dispose();
+    }
+
+    values.clear();
+    snapshot.reset();
+  }
+
+  ConfigValueCache::~ConfigValueCache() {
+    clear();
+  }
+
+}
+
+/* eof */
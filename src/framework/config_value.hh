@@ -0,0 +1,202 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Config value interface; native snapshot of the evaluated configuration
+ * \package framework
+ *
+ * A config value is a node of the native, immutable copy of the evaluated
+ * configuration, so that reading config values doesn't need V8 lookups
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONFIG_VALUE_H
+#define CONFIG_VALUE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <v8.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include "hash_map.hh"
+
+namespace CForum {
+  class ConfigValueCache;
+
+  class ConfigValue {
+  public:
+    enum Type {
+      TypeNull,
+      TypeBool,
+      TypeNumber,
+      TypeString,
+      TypeArray,
+      TypeObject
+    };
+
+    typedef std::vector<ConfigValue> ArrayType;
+    typedef std::vector<std::pair<std::string, ConfigValue> > ObjectType;
+
+    ConfigValue();
+
+    static ConfigValue fromV8(v8::Handle<v8::Value>, int = 0);
+    v8::Local<v8::Value> toV8(ConfigValueCache * = NULL) const;
+
+    Type getType() const;
+
+    bool isNull() const;
+    bool isBool() const;
+    bool isNumber() const;
+    bool isString() const;
+    bool isArray() const;
+    bool isObject() const;
+
+    bool asBool() const;
+    double asNumber() const;
+    long asInt() const;
+    const std::string &asString() const;
+
+    const ArrayType &getArray() const;
+    const ObjectType &getObject() const;
+
+    size_t size() const;
+    const ConfigValue *at(size_t) const;
+    const ConfigValue *get(const std::string &) const;
+    const ConfigValue *get(const char *, size_t) const;
+
+    const ConfigValue *getByPath(const std::string &) const;
+
+    bool operator==(const ConfigValue &) const;
+    bool operator!=(const ConfigValue &) const;
+
+  private:
+    Type _type;
+    bool _bool;
+    double _number;
+    std::string _string;
+    ArrayType _array;
+    ObjectType _object;
+  };
+
+  /**
+   * The V8 strings and numbers of one snapshot, kept for one isolate; they
+   * don't belong to a context, so all templates of the isolate share them.
+   * Objects and arrays do belong to one, they are built for every read
+   */
+  class ConfigValueCache {
+  public:
+    ConfigValueCache();
+    ~ConfigValueCache();
+
+    v8::Local<v8::Value> get(boost::shared_ptr<const ConfigValue>, const ConfigValue &);
+    v8::Local<v8::Value> getPrimitive(const ConfigValue &);
+
+    void clear();
+
+  private:
+    ConfigValueCache(const ConfigValueCache &);
+    ConfigValueCache &operator=(const ConfigValueCache &);
+
+    /* keeps the nodes alive, their addresses are our keys */
+    boost::shared_ptr<const ConfigValue> snapshot;
+    std::unordered_map<const ConfigValue *, v8::Persistent<v8::Value> > values;
+  };
+
+  inline ConfigValue::Type ConfigValue::getType() const {
+    return _type;
+  }
+
+  inline const ConfigValue *ConfigValue::get(const std::string &key) const {
+    return get(key.data(), key.length());
+  }
+
+  inline bool ConfigValue::operator!=(const ConfigValue &other) const {
+    return !(*this == other);
+  }
+
+  inline bool ConfigValue::isNull() const {
+    return _type == TypeNull;
+  }
+
+  inline bool ConfigValue::isBool() const {
+    return _type == TypeBool;
+  }
+
+  inline bool ConfigValue::isNumber() const {
+    return _type == TypeNumber;
+  }
+
+  inline bool ConfigValue::isString() const {
+    return _type == TypeString;
+  }
+
+  inline bool ConfigValue::isArray() const {
+    return _type == TypeArray;
+  }
+
+  inline bool ConfigValue::isObject() const {
+    return _type == TypeObject;
+  }
+
+  inline bool ConfigValue::asBool() const {
+    return _bool;
+  }
+
+  inline double ConfigValue::asNumber() const {
+    return _number;
+  }
+
+  inline long ConfigValue::asInt() const {
+    return (long)_number;
+  }
+
+  inline const std::string &ConfigValue::asString() const {
+    return _string;
+  }
+
+  inline const ConfigValue::ArrayType &ConfigValue::getArray() const {
+    return _array;
+  }
+
+  inline const ConfigValue::ObjectType &ConfigValue::getObject() const {
+    return _object;
+  }
+
+  inline size_t ConfigValue::size() const {
+    return _type == TypeArray ? _array.size() : _object.size();
+  }
+
+  inline const ConfigValue *ConfigValue::at(size_t i) const {
+    return _type == TypeArray && i < _array.size() ? &_array[i] : NULL;
+  }
+
+}
+
+#endif
+
+/* eof */
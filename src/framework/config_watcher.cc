@@ -0,0 +1,156 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Config watcher implementation; notices requests to reload the configuration
+ * \package framework
+ *
+ * The config watcher notices when the configuration should be reloaded: on
+ * SIGHUP and, where inotify is available, when the config file changes
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/config_watcher.hh"
+
+namespace CForum {
+  volatile sig_atomic_t ConfigWatcher::reloadRequested = 0;
+
+  static void reloadHandler(int) {
+    ConfigWatcher::requestReload();
+  }
+
+  ConfigWatcher::ConfigWatcher() : inotifyFd(-1), directory(), basename() { }
+
+  void ConfigWatcher::requestReload() {
+    reloadRequested = 1;
+  }
+
+  void ConfigWatcher::watch(const std::string &file) {
+    struct sigaction sa;
+    size_t pos;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = reloadHandler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGHUP, &sa, NULL);
+
+    if((pos = file.rfind('/')) != std::string::npos) {
+      directory = pos == 0 ? "/" : file.substr(0, pos);
+      basename  = file.substr(pos + 1);
+    }
+    else {
+      directory = ".";
+      basename  = file;
+    }
+
+#ifdef HAVE_SYS_INOTIFY_H
+    /* editors tend to replace the file instead of writing it, so watch the directory */
+    if(inotifyFd == -1 && (inotifyFd = inotify_init()) != -1) {
+      fcntl(inotifyFd, F_SETFL, fcntl(inotifyFd, F_GETFL, 0) | O_NONBLOCK);
+      fcntl(inotifyFd, F_SETFD, FD_CLOEXEC);
+
+      if(inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) == -1) {
+        close(inotifyFd);
+        inotifyFd = -1;
+      }
+    }
+#endif
+  }
+
+  void ConfigWatcher::stop() {
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_IGN;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGHUP, &sa, NULL);
+
+    if(inotifyFd != -1) {
+      close(inotifyFd);
+      inotifyFd = -1;
+    }
+
+    reloadRequested = 0;
+  }
+
+  bool ConfigWatcher::fileChanged() {
+    bool changed = false;
+
+#ifdef HAVE_SYS_INOTIFY_H
+    char buff[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *ev;
+    ssize_t len;
+    char *ptr;
+
+    if(inotifyFd == -1) {
+      return false;
+    }
+
+    while((len = read(inotifyFd, buff, sizeof(buff))) > 0) {
+      for(ptr = buff; ptr < buff + len; ptr += sizeof(struct inotify_event) + ev->len) {
+        ev = (const struct inotify_event *)ptr;
+
+        if(ev->len > 0 && basename == ev->name) {
+          changed = true;
+        }
+      }
+    }
+#endif
+
+    return changed;
+  }
+
+  bool ConfigWatcher::pending() {
+    bool changed = fileChanged();
+
+    if(reloadRequested) {
+      reloadRequested = 0;
+      changed = true;
+    }
+
+    return changed;
+  }
+
+  bool ConfigWatcher::wait(int timeout) {
+    struct pollfd pfd;
+
+    /* a SIGHUP interrupts the poll, so both sources are noticed right away */
+    if(!reloadRequested) {
+      pfd.fd      = inotifyFd;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+
+      poll(&pfd, inotifyFd == -1 ? 0 : 1, timeout);
+    }
+
+    return pending();
+  }
+
+  ConfigWatcher::~ConfigWatcher() {
+    if(inotifyFd != -1) {
+      close(inotifyFd);
+    }
+  }
+
+}
+
+/* eof */
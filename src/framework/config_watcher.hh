@@ -0,0 +1,84 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Config watcher interface; notices requests to reload the configuration
+ * \package framework
+ *
+ * The config watcher notices when the configuration should be reloaded: on
+ * SIGHUP and, where inotify is available, when the config file changes
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include <string>
+
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+
+namespace CForum {
+  class ConfigWatcher {
+  public:
+    ConfigWatcher();
+    ~ConfigWatcher();
+
+    void watch(const std::string &);
+    void stop();
+
+    bool pending();
+    bool wait(int);
+    int getFd() const;
+
+    static void requestReload();
+
+  private:
+    ConfigWatcher(const ConfigWatcher &);
+    ConfigWatcher &operator=(const ConfigWatcher &);
+
+    bool fileChanged();
+
+    int inotifyFd;
+    std::string directory, basename;
+
+    static volatile sig_atomic_t reloadRequested;
+  };
+
+  inline int ConfigWatcher::getFd() const {
+    return inotifyFd;
+  }
+
+}
+
+#endif
+
+/* eof */
@@ -31,8 +31,8 @@
 #include "framework/configparser.hh"
 
 namespace CForum {
-  Configparser::Configparser() : _evaluator(), _script(), _result(), _parsed(false) { }
-  Configparser::Configparser(const Configparser &) : _evaluator(), _script(), _result(), _parsed(false) { }
+  Configparser::Configparser() : _filename(), _snapshot(boost::make_shared<ConfigValue>()), _parsed(false) { }
+  Configparser::Configparser(const Configparser &) : _filename(), _snapshot(boost::make_shared<ConfigValue>()), _parsed(false) { }
 
   std::string Configparser::findFile() {
     static const char *locations[] = {
@@ -69,8 +69,10 @@ namespace CForum {
     }
 
     try {
-      _script = _evaluator.compileFile(_filename);
-      _result = _evaluator.evaluateScript(_script);
+      JSEvaluator evaluator;
+      v8::Local<v8::Script> script = evaluator.compileFile(_filename);
+
+      _snapshot = boost::make_shared<ConfigValue>(ConfigValue::fromV8(evaluator.evaluateScript(script)));
       _parsed = true;
     }
     catch(JSEvaluatorException &e) {
@@ -78,16 +80,19 @@ namespace CForum {
     }
   }
 
-  v8::Local<v8::Value> Configparser::getValue(const std::string &name, bool may_be_null) {
-    v8::Local<v8::Object> obj = _result->ToObject();
-    v8::Local<v8::String> str = v8::String::New(name.c_str(), name.length());
-    v8::Local<v8::Value> val = obj->Get(str);
+  /* values are built from the snapshot in the caller's context, reusing what the isolate's cache has */
+  v8::Local<v8::Value> Configparser::getValue(const std::string &name, bool may_be_null, ConfigValueCache *cache) {
+    const ConfigValue *val = _snapshot->get(name);
+
+    if(val == NULL || val->isNull()) {
+      if(!may_be_null) {
+        throw ConfigErrorException(std::string("Key ") + name + std::string(" does not exist or is null!"), ConfigErrorException::NotExistantOrNull);
+      }
 
-    if(!may_be_null && (val->IsNull() || val->IsUndefined())) {
-      throw ConfigErrorException(std::string("Key ") + name + std::string(" does not exist or is null!"), ConfigErrorException::NotExistantOrNull);
+      return v8::Local<v8::Value>::New(v8::Undefined());
     }
 
-    return val;
+    return cache ? cache->get(_snapshot, *val) : val->toV8();
   }
 
   std::string Configparser::getStrValue(const std::string &name) {
@@ -101,95 +106,29 @@ namespace CForum {
     return std::string(*utf8);
   }
 
-  inline int toInt(const std::string &str, bool *numeric) {
-    const char *ptr = str.c_str();
-    int num = 0;
+  const ConfigValue &Configparser::getNode(const std::string &name, bool may_be_null) const {
+    static const ConfigValue null_value;
+    const ConfigValue *val = _snapshot->getByPath(name);
 
-    *numeric = true;
-
-    for(; *ptr; ++ptr) {
-      if(isdigit(*ptr)) {
-        num = num * 10 + (*ptr - '0');
-      }
-      else {
-        *numeric = false;
-        return 0;
+    if(val == NULL || val->isNull()) {
+      if(!may_be_null) {
+        throw ConfigErrorException(std::string("Key ") + name + std::string(" does not exist or is null!"), ConfigErrorException::NotExistantOrNull);
       }
-    }
-
-    return num;
-  }
-
-  v8::Local<v8::Value> Configparser::getByPath(const std::string &name, bool may_be_null) {
-    std::istringstream iss(name);
-    std::vector<std::string> names;
-    std::vector<std::string>::iterator it,end;
-    v8::Local<v8::Value> cfgval;
-    v8::Local<v8::Object> obj;
-    v8::Local<v8::Array> ary;
-    v8::Local<v8::Value> key;
-    v8::Local<v8::Number> nkey;
-
-    std::string str;
-    int i;
-    bool numeric;
-
-    if(name[0] == '/') {
-      str = name.substr(1);
-    }
-    else {
-      str = name;
-    }
 
-    if(str[str.length()-1] == '/') {
-      str = str.substr(0, str.length() - 1);
+      return null_value;
     }
 
-    boost::split(names, str, boost::is_any_of("/"));
-
-    it  = names.begin();
-    end = names.end();
-
-    cfgval = getValue(*it);
-    for(++it; it != end; ++it) {
-      i = toInt(*it, &numeric);
-
-      if(numeric) {
-        if(!cfgval->IsArray()) {
-          if(may_be_null) {
-            return v8::Local<v8::Value>::New(v8::Undefined());
-          }
-          else {
-            throw ConfigErrorException("Key \"" + *it + "\" in path <" + name + "> is not an array!", ConfigErrorException::NotAnObjectError);
-          }
-        }
-
-        obj    = cfgval->ToObject();
-        nkey   = v8::Number::New((double)i);
-        cfgval = obj->Get(nkey);
-      }
-      else {
-        if(!cfgval->IsObject()) {
-          if(may_be_null) {
-            return v8::Local<v8::Value>::New(v8::Undefined());
-          }
-          else {
-            throw ConfigErrorException("Key \"" + *it + "\" in path <" + name + "> is not an object!", ConfigErrorException::NotAnObjectError);
-          }
-        }
-
-        key    = v8::String::New(it->c_str());
-        obj    = cfgval->ToObject();
-        cfgval = obj->Get(key);
-      }
+    return *val;
+  }
 
-    }
+  v8::Local<v8::Value> Configparser::getByPath(const std::string &name, bool may_be_null, ConfigValueCache *cache) {
+    const ConfigValue &val = getNode(name, may_be_null);
 
-    if(!may_be_null && (cfgval->IsNull() || cfgval->IsUndefined())) {
-      throw ConfigErrorException(std::string("Key ") + name + std::string(" does not exist or is null!"), ConfigErrorException::NotExistantOrNull);
+    if(val.isNull()) {
+      return v8::Local<v8::Value>::New(v8::Undefined());
     }
 
-    return cfgval;
+    return cache ? cache->get(_snapshot, val) : val.toV8();
   }
 
 
@@ -45,7 +45,11 @@
 
 #include <v8.h>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
 #include "jsevaluator/js_evaluator.hh"
+#include "framework/config_value.hh"
 #include "framework/config_error_exception.hh"
 
 namespace CForum {
@@ -58,11 +62,14 @@ namespace CForum {
     std::string findFile();
     void parse(std::string = "");
 
-    v8::Local<v8::Value> getValue(const std::string &, bool = true);
-    v8::Local<v8::Value> getByPath(const std::string &, bool = true);
+    v8::Local<v8::Value> getValue(const std::string &, bool = true, ConfigValueCache * = NULL);
+    v8::Local<v8::Value> getByPath(const std::string &, bool = true, ConfigValueCache * = NULL);
 
     std::string getStrValue(const std::string &);
 
+    const ConfigValue &getNode(const std::string &, bool = true) const;
+    boost::shared_ptr<const ConfigValue> getSnapshot() const;
+
     bool isParsed() const;
 
   private:
@@ -71,10 +78,12 @@ namespace CForum {
 
     std::string _filename;
 
-    JSEvaluator _evaluator;
-
-    v8::Local<v8::Script> _script;
-    v8::Local<v8::Value> _result;
+    /*
+     * the file is evaluated in a context of its own that is gone after
+     * parse(); only the snapshot stays, so one parser can be shared by all
+     * threads and be dropped by any of them
+     */
+    boost::shared_ptr<const ConfigValue> _snapshot;
 
     bool _parsed;
 
@@ -85,6 +94,10 @@ namespace CForum {
     return _parsed;
   }
 
+  inline boost::shared_ptr<const ConfigValue> Configparser::getSnapshot() const {
+    return _snapshot;
+  }
+
 }
 
 
@@ -31,6 +31,7 @@
  */
 
 #include "framework/controller.hh"
+#include "framework/route_vars.hh"
 
 namespace CForum {
   Controller::Controller() : request(), view() { }
@@ -38,18 +39,28 @@ namespace CForum {
   void Controller::preRoute(boost::shared_ptr<Request>) {}
 
   std::string Controller::generateFilename(const std::string &view) {
-    v8::String::Utf8Value path(app->getConfigparser()->getByPath("system/views", false)->ToString());
-    return std::string(*path) + "/" + view;
+    return app->getViewsDir() + "/" + view;
   }
 
   const std::string Controller::handleRequest(boost::shared_ptr<Request> rq, const std::map<std::string, std::string> &) {
     if(view != "") {
-      return rq->getTemplate()->evaluateFile(generateFilename(view));
+      return render(rq, view);
     }
 
     return std::string();
   }
 
+  /* the router calls this one; controllers that want the captures without copies override it */
+  const std::string Controller::handleRoute(boost::shared_ptr<Request> rq, const RouteVars &vars) {
+    return handleRequest(rq, vars.getMap());
+  }
+
+  std::string Controller::render(boost::shared_ptr<Request> rq, const std::string &view_name) {
+    /* the page goes out while it is rendered; the headers with its first chunk */
+    rq->getTemplate()->renderFile(generateFilename(view_name), rq->getOutputStream());
+    return std::string();
+  }
+
   void Controller::postRoute(boost::shared_ptr<Request>) {}
 
   Controller::~Controller() { }
@@ -38,6 +38,7 @@
 
 namespace CForum {
   class Application; // needed due to circular dependencies
+  class RouteVars;
 
   class Controller {
   public:
@@ -49,10 +50,12 @@ namespace CForum {
 
     virtual void preRoute(boost::shared_ptr<Request>);
     virtual const std::string handleRequest(boost::shared_ptr<Request>, const std::map<std::string, std::string> &);
+    virtual const std::string handleRoute(boost::shared_ptr<Request>, const RouteVars &);
     virtual void postRoute(boost::shared_ptr<Request>);
 
   protected:
     virtual std::string generateFilename(const std::string &);
+    virtual std::string render(boost::shared_ptr<Request>, const std::string &);
 
     boost::shared_ptr<Request> request;
     std::string view;
@@ -0,0 +1,263 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief FastCGI application implementation
+ * \package framework
+ *
+ * FastCGI application implementation: initializes once, then accepts and
+ * handles requests from the FastCGI listening socket in a loop
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/fastcgi_application.hh"
+
+namespace CForum {
+  volatile int FastCGIApplication::activeRequests = 0;
+  volatile sig_atomic_t FastCGIApplication::stopRequested = 0;
+
+  FastCGIApplication::FastCGIApplication() : Application(), listenSocket(0), threadCount(0), runningThreads(0), acceptingThread(), accepting(0) {
+    pthread_mutex_init(&acceptLock, NULL);
+  }
+
+  void FastCGIApplication::configure() {
+    Application::configure();
+
+    if(FCGX_Init() != 0) {
+      throw FrameworkErrorException("Error initializing the FastCGI library", FrameworkErrorException::FastCGIError);
+    }
+
+    threadCount = (int)configparser->getNode("system/threads/count").asInt();
+  }
+
+  void FastCGIApplication::initWorker() {
+    /* worker threads connect on their own */
+    if(threadCount <= 0) {
+      Application::initWorker();
+    }
+  }
+
+  void FastCGIApplication::handleRequest() {
+    std::vector<pthread_t> threads;
+    struct sigaction sa;
+    pthread_t thread;
+    int i;
+
+    /* we may be stopped gracefully, e.g. to recycle us after a reload */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stopHandler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if(threadCount <= 0) {
+      acceptLoop();
+      return;
+    }
+
+    runningThreads = threadCount;
+
+    for(i = 0; i < threadCount; ++i) {
+      if(pthread_create(&thread, NULL, workerThread, this) != 0) {
+        break;
+      }
+
+      threads.push_back(thread);
+    }
+
+    if(threads.empty()) {
+      throw FrameworkErrorException("Error creating worker threads", FrameworkErrorException::WorkerError);
+    }
+
+    __sync_sub_and_fetch(&runningThreads, threadCount - (int)threads.size());
+
+    /*
+     * the main thread reloads the config while the workers serve; they pick
+     * the new generation up between two requests
+     */
+    while(runningThreads > 0) {
+      /* the signal may have hit any thread; wake the one waiting in accept(), leave the busy ones alone */
+      if(stopRequested && accepting) {
+        pthread_kill(acceptingThread, SIGTERM);
+      }
+
+      if(waitForReload(1000)) {
+        v8::Locker locker;
+        v8::HandleScope scope;
+
+        reload();
+      }
+    }
+
+    for(std::vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it) {
+      pthread_join(*it, NULL);
+    }
+  }
+
+  void *FastCGIApplication::workerThread(void *arg) {
+    FastCGIApplication *app = reinterpret_cast<FastCGIApplication *>(arg);
+
+    app->runWorkerThread();
+    __sync_sub_and_fetch(&app->runningThreads, 1);
+
+    return NULL;
+  }
+
+  /*
+   * FCGX_Accept_r() may already be reading the params of a request the web
+   * server handed over, so we never exit from here; without SA_RESTART the
+   * accept returns -1 and the loops wind down on their own
+   */
+  void FastCGIApplication::stopHandler(int) {
+    stopRequested = 1;
+    FCGX_ShutdownPending();
+  }
+
+  void FastCGIApplication::runWorkerThread() {
+    v8::Isolate *isolate = v8::Isolate::New();
+
+    {
+      v8::Locker locker(isolate);
+      v8::Isolate::Scope isolate_scope(isolate);
+
+      try {
+        boost::shared_ptr<WorkerState> state = createWorkerState();
+
+        setWorkerState(state.get());
+        acceptLoop();
+        setWorkerState(NULL);
+      }
+      catch(CForumException &e) {
+        setWorkerState(NULL);
+        std::cerr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      }
+    }
+
+    isolate->Dispose();
+  }
+
+  void FastCGIApplication::acceptLoop() {
+    FCGX_Request rq;
+    int rc;
+
+    if(FCGX_InitRequest(&rq, listenSocket, 0) != 0) {
+      throw FrameworkErrorException("Error initializing the FastCGI request", FrameworkErrorException::FastCGIError);
+    }
+
+    while(!workerExhausted() && !stopRequested) {
+      /* some platforms don't allow concurrent accept() calls on the same socket */
+      pthread_mutex_lock(&acceptLock);
+      acceptingThread = pthread_self();
+      accepting = 1;
+      rc = stopRequested ? -1 : FCGX_Accept_r(&rq);
+      accepting = 0;
+      pthread_mutex_unlock(&acceptLock);
+
+      if(rc < 0) {
+        break;
+      }
+
+      __sync_add_and_fetch(&activeRequests, 1);
+
+      /* worker threads get the reloaded config from the main thread with the next request */
+      if(threadCount <= 0) {
+        checkReload();
+      }
+
+      handleFastCGIRequest(&rq);
+      FCGX_Finish_r(&rq);
+
+      /* the last one turns out the lights */
+      if(__sync_sub_and_fetch(&activeRequests, 1) == 0 && stopRequested) {
+        _exit(EXIT_SUCCESS);
+      }
+    }
+
+    FCGX_Free(&rq, 1);
+  }
+
+  void FastCGIApplication::handleFastCGIRequest(FCGX_Request *fcgi_rq) {
+    v8::HandleScope scope;
+    boost::shared_ptr<FastCGIRequest> rq;
+    std::string status = "500 Internal Server Error", body, location;
+
+    try {
+      rq = boost::make_shared<FastCGIRequest>(fcgi_rq);
+      run(rq);
+      return;
+    }
+    catch(NotFoundException &e) {
+      std::ostringstream ostr;
+      ostr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")\012";
+      status = "404 Not Found";
+      body   = ostr.str();
+    }
+    catch(RedirectException &e) {
+      std::ostringstream ostr;
+      ostr << e.getStatus();
+      status   = ostr.str();
+      body     = "You've been redirected to " + e.getUrl() + "\012";
+      location = e.getUrl();
+    }
+    catch(CGIParserException &e) {
+      std::ostringstream ostr;
+      ostr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")\012";
+      status = e.getCode() == CGIParserException::BodyTooLarge || e.getCode() == CGIParserException::FieldTooLarge ? "413 Request Entity Too Large" : "400 Bad Request";
+      body   = ostr.str();
+    }
+    catch(CForumException &e) {
+      std::ostringstream ostr;
+      ostr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")\012";
+      body = ostr.str();
+    }
+    catch(std::exception &e) {
+      body = std::string("ERROR: ") + e.what() + "\012";
+    }
+
+    /* the headers went out with the first chunk; the response just ends here */
+    if(rq && rq->isCommitted()) {
+      FCGX_PutStr(body.c_str(), (int)body.length(), fcgi_rq->err);
+      return;
+    }
+
+    sendError(fcgi_rq, status, body, location);
+  }
+
+  void FastCGIApplication::sendError(FCGX_Request *rq, const std::string &status, const std::string &body, const std::string &location) {
+    std::ostringstream ostr;
+
+    ostr << "Status: " << status << "\015\012";
+    if(!location.empty()) {
+      ostr << "Location: " << location << "\015\012";
+    }
+    ostr << "Content-Type: text/plain; charset=utf-8\015\012\015\012" << body;
+
+    std::string str = ostr.str();
+    FCGX_PutStr(str.c_str(), (int)str.length(), rq->out);
+  }
+
+  FastCGIApplication::~FastCGIApplication() {
+    pthread_mutex_destroy(&acceptLock);
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,98 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief FastCGI application interface
+ * \package framework
+ *
+ * FastCGI application interface: a persistent process serving requests
+ * from the FastCGI listening socket
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FASTCGI_APPLICATION_H
+#define FASTCGI_APPLICATION_H
+
+#include <sstream>
+#include <vector>
+#include <iostream>
+
+#include <pthread.h>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+
+#include <fcgiapp.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "framework/application.hh"
+
+#include "cgi/cgi.hh"
+#include "framework/fastcgi_request.hh"
+
+#include "framework/not_found_exception.hh"
+#include "framework/redirect_exception.hh"
+
+namespace CForum {
+  class FastCGIApplication : public Application {
+  public:
+    FastCGIApplication();
+    virtual ~FastCGIApplication();
+
+    virtual void configure();
+    virtual void initWorker();
+    virtual void handleRequest();
+
+    int getThreadCount() const;
+
+  protected:
+    virtual void acceptLoop();
+    virtual void runWorkerThread();
+    static void *workerThread(void *);
+    static void stopHandler(int);
+
+    virtual void handleFastCGIRequest(FCGX_Request *);
+    virtual void sendError(FCGX_Request *, const std::string &, const std::string &, const std::string & = "");
+
+    int listenSocket, threadCount;
+    volatile int runningThreads;
+    pthread_mutex_t acceptLock;
+
+    /* the thread blocked in FCGX_Accept_r(), valid while accepting is set */
+    pthread_t acceptingThread;
+    volatile int accepting;
+
+    static volatile int activeRequests;
+    static volatile sig_atomic_t stopRequested;
+
+  };
+
+  inline int FastCGIApplication::getThreadCount() const {
+    return threadCount;
+  }
+}
+
+#endif
+
+/* eof */
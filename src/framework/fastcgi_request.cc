@@ -0,0 +1,75 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief FastCGI Request information, comes via FastCGI parameters
+ * \package framework
+ *
+ * FastCGI Request information, comes via FastCGI parameters
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/fastcgi_request.hh"
+
+namespace CForum {
+  class FCGXInput : public CGI::Input {
+  public:
+    FCGXInput(FCGX_Stream *str) : stream(str) { }
+
+    virtual size_t read(char *buff, size_t len) {
+      int rd = FCGX_GetStr(buff, (int)len, stream);
+      return rd > 0 ? (size_t)rd : 0;
+    }
+
+  private:
+    FCGX_Stream *stream;
+  };
+
+  CGI FastCGIRequest::fromFCGXRequest(FCGX_Request *rq) {
+    FCGXInput in(rq->in);
+    return CGI::fromEnvironment(const_cast<const char **>(rq->envp), &in);
+  }
+
+  FastCGIRequest::FastCGIRequest(FCGX_Request *rq) : CGIRequest(fromFCGXRequest(rq)), fcgiRequest(rq) { }
+
+  FastCGIRequest::FastCGIRequest(const FastCGIRequest &rq) : CGIRequest(rq), fcgiRequest(rq.fcgiRequest) { }
+  FastCGIRequest &FastCGIRequest::operator=(const FastCGIRequest &) {
+    return *this;
+  }
+
+  void FastCGIRequest::writeResponse() {
+    const struct iovec *iov = response.getSegments();
+    size_t i, cnt = response.getSegmentCount();
+
+    /* the FastCGI library frames the segments into records itself */
+    for(i = 0; i < cnt; ++i) {
+      FCGX_PutStr(reinterpret_cast<const char *>(iov[i].iov_base), (int)iov[i].iov_len, fcgiRequest->out);
+    }
+
+    response.clear();
+  }
+
+  FastCGIRequest::~FastCGIRequest() { }
+
+}
+
+/* eof */
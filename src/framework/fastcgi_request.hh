@@ -0,0 +1,65 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief FastCGI Request information, comes via FastCGI parameters
+ * \package framework
+ *
+ * FastCGI Request information, comes via FastCGI parameters
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FASTCGI_REQUEST_H
+#define FASTCGI_REQUEST_H
+
+#include <fcgiapp.h>
+
+#include "framework/cgi_request.hh"
+
+namespace CForum {
+  class FastCGIRequest : public CGIRequest {
+  public:
+    FastCGIRequest(FCGX_Request *);
+    virtual ~FastCGIRequest();
+
+    FCGX_Request *getFCGXRequest();
+
+    static CGI fromFCGXRequest(FCGX_Request *);
+
+  protected:
+    virtual void writeResponse();
+
+    FCGX_Request *fcgiRequest;
+
+  private:
+    FastCGIRequest(const FastCGIRequest &);
+    FastCGIRequest &operator=(const FastCGIRequest &);
+  };
+
+  inline FCGX_Request *FastCGIRequest::getFCGXRequest() {
+    return fcgiRequest;
+  }
+}
+
+#endif
+
+/* eof */
@@ -42,6 +42,9 @@ namespace CForum {
     FrameworkErrorException(const std::string &, int);
 
     static const int MongoConnectionError = 0x4fd30e9c;
+    static const int FastCGIError         = 0x4fe2a1c0;
+    static const int HTTPSocketError      = 0x4fe3f2d4;
+    static const int WorkerError          = 0x4fe58a31;
   };
 
 }
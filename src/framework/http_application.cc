@@ -0,0 +1,481 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP application implementation; built-in event driven HTTP/1.1 server
+ * \package framework
+ *
+ * The HTTP application listens on a TCP or Unix domain socket and serves
+ * HTTP/1.1 requests (with keep-alive and pipelining) directly, without a
+ * CGI or FastCGI gateway in between
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/http_application.hh"
+
+namespace CForum {
+  volatile sig_atomic_t HTTPApplication::shutdownRequested = 0;
+
+  static void shutdownHandler(int) {
+    HTTPApplication::requestShutdown();
+  }
+
+  HTTPApplication::HTTPApplication() : Application(), listenSocket(-1), listenPort(80), epollFd(-1), keepAliveTimeout(15), maxHeaderSize(16384), maxBodySize(8388608), maxPendingOutput(1048576), connections() { }
+
+  void HTTPApplication::requestShutdown() {
+    shutdownRequested = 1;
+  }
+
+  void HTTPApplication::configure() {
+    Application::configure();
+
+    const ConfigValue &timeout = configparser->getNode("system/http/keepalive-timeout");
+    if(timeout.isNumber()) {
+      keepAliveTimeout = (int)timeout.asInt();
+    }
+
+    const ConfigValue &max_body = configparser->getNode("system/http/max-body");
+    if(max_body.isNumber()) {
+      maxBodySize = (size_t)max_body.asInt();
+    }
+
+    if(listenAddress.empty()) {
+      const ConfigValue &listen = configparser->getNode("system/http/listen");
+      listenAddress = listen.isString() ? listen.asString() : "localhost:8080";
+    }
+
+    openListenSocket();
+  }
+
+  static void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+
+    if(flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+      throw FrameworkErrorException(std::string("Error setting socket non-blocking: ") + strerror(errno), FrameworkErrorException::HTTPSocketError);
+    }
+  }
+
+  void HTTPApplication::openListenSocket() {
+    int one = 1, ret;
+
+    if(listenAddress.compare(0, 5, "unix:") == 0) {
+      struct sockaddr_un sun;
+      std::string path = listenAddress.substr(5);
+
+      if(path.length() >= sizeof(sun.sun_path)) {
+        throw FrameworkErrorException("Unix socket path too long: " + path, FrameworkErrorException::HTTPSocketError);
+      }
+
+      memset(&sun, 0, sizeof(sun));
+      sun.sun_family = AF_UNIX;
+      strcpy(sun.sun_path, path.c_str());
+
+      unlink(path.c_str());
+
+      if((listenSocket = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 || bind(listenSocket, (struct sockaddr *)&sun, sizeof(sun)) == -1) {
+        throw FrameworkErrorException("Error binding to " + listenAddress + ": " + strerror(errno), FrameworkErrorException::HTTPSocketError);
+      }
+    }
+    else {
+      struct addrinfo hints, *res, *ai;
+      std::string host, port = listenAddress;
+      size_t pos;
+
+      if((pos = listenAddress.rfind(':')) != std::string::npos) {
+        host = listenAddress.substr(0, pos);
+        port = listenAddress.substr(pos + 1);
+
+        /* [::1]:8080 */
+        if(host.length() > 1 && host[0] == '[' && host[host.length() - 1] == ']') {
+          host = host.substr(1, host.length() - 2);
+        }
+      }
+
+      memset(&hints, 0, sizeof(hints));
+      hints.ai_family   = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_flags    = AI_PASSIVE;
+
+      if((ret = getaddrinfo(host.empty() ? NULL : host.c_str(), port.c_str(), &hints, &res)) != 0) {
+        throw FrameworkErrorException("Error resolving " + listenAddress + ": " + gai_strerror(ret), FrameworkErrorException::HTTPSocketError);
+      }
+
+      for(ai = res; ai != NULL; ai = ai->ai_next) {
+        if((listenSocket = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)) == -1) {
+          continue;
+        }
+
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        if(bind(listenSocket, ai->ai_addr, ai->ai_addrlen) == 0) {
+          break;
+        }
+
+        close(listenSocket);
+        listenSocket = -1;
+      }
+
+      freeaddrinfo(res);
+
+      if(listenSocket == -1) {
+        throw FrameworkErrorException("Error binding to " + listenAddress + ": " + strerror(errno), FrameworkErrorException::HTTPSocketError);
+      }
+
+      listenPort = atoi(port.c_str());
+    }
+
+    if(listen(listenSocket, SOMAXCONN) == -1) {
+      throw FrameworkErrorException("Error listening on " + listenAddress + ": " + strerror(errno), FrameworkErrorException::HTTPSocketError);
+    }
+
+    setNonBlocking(listenSocket);
+  }
+
+  void HTTPApplication::handleRequest() {
+    struct epoll_event ev, events[256];
+    struct sigaction sa;
+    time_t lastSweep = time(NULL);
+    bool draining = false, exhausted = false;
+    int num, i;
+
+    /* no SA_RESTART: we want epoll_wait() to return on shutdown */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = shutdownHandler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    signal(SIGPIPE, SIG_IGN);
+
+    if((epollFd = epoll_create(1024)) == -1) {
+      throw FrameworkErrorException(std::string("Error creating epoll instance: ") + strerror(errno), FrameworkErrorException::HTTPSocketError);
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events  = EPOLLIN;
+    ev.data.fd = listenSocket;
+
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, listenSocket, &ev) == -1) {
+      throw FrameworkErrorException(std::string("Error adding listen socket to epoll: ") + strerror(errno), FrameworkErrorException::HTTPSocketError);
+    }
+
+    while(!draining || !connections.empty()) {
+      if((num = epoll_wait(epollFd, events, sizeof(events) / sizeof(*events), 1000)) == -1) {
+        if(errno != EINTR) {
+          throw FrameworkErrorException(std::string("Error waiting for events: ") + strerror(errno), FrameworkErrorException::HTTPSocketError);
+        }
+
+        num = 0;
+      }
+
+      for(i = 0; i < num; ++i) {
+        if(events[i].data.fd == listenSocket) {
+          if(!draining) {
+            acceptConnections();
+          }
+
+          continue;
+        }
+
+        std::unordered_map<int, ConnectionPtr>::iterator it = connections.find(events[i].data.fd);
+        if(it == connections.end()) {
+          continue;
+        }
+
+        ConnectionPtr conn = it->second;
+        bool eof = false;
+
+        if(events[i].events & EPOLLIN) {
+          eof = !conn->readInput();
+        }
+        else if(events[i].events & (EPOLLERR | EPOLLHUP)) {
+          closeConnection(conn);
+          continue;
+        }
+
+        if((events[i].events & EPOLLOUT) && !conn->writeOutput()) {
+          closeConnection(conn);
+          continue;
+        }
+
+        processInput(conn);
+
+        /* peer closed its side: we answered what we got, now close */
+        if(eof) {
+          conn->setCloseAfterWrite();
+        }
+
+        updateConnection(conn);
+      }
+
+      if(time(NULL) != lastSweep) {
+        lastSweep = time(NULL);
+        closeIdleConnections();
+        exhausted = workerExhausted();
+
+        /* requests run one at a time here, so none sees the swap */
+        if(!draining) {
+          checkReload();
+        }
+      }
+
+      /* on shutdown or when recycled we stop accepting and finish our connections */
+      if(!draining && (shutdownRequested || exhausted)) {
+        draining = true;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, listenSocket, NULL);
+        drainConnections();
+      }
+    }
+
+    close(epollFd);
+    epollFd = -1;
+  }
+
+  void HTTPApplication::acceptConnections() {
+    struct sockaddr_storage sa;
+    struct epoll_event ev;
+    socklen_t len;
+    char addr[INET6_ADDRSTRLEN];
+    int fd, one = 1;
+
+    for(;;) {
+      len = sizeof(sa);
+
+      if((fd = accept(listenSocket, (struct sockaddr *)&sa, &len)) == -1) {
+        if(errno == EINTR || errno == ECONNABORTED) {
+          continue;
+        }
+
+        /* EAGAIN means we accepted everything; EMFILE et al. are retried on the next event */
+        return;
+      }
+
+      addr[0] = '\0';
+      if(sa.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in *)&sa)->sin_addr, addr, sizeof(addr));
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      }
+      else if(sa.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &((struct sockaddr_in6 *)&sa)->sin6_addr, addr, sizeof(addr));
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      }
+
+      try {
+        setNonBlocking(fd);
+      }
+      catch(FrameworkErrorException &) {
+        close(fd);
+        continue;
+      }
+
+      ConnectionPtr conn = boost::make_shared<HTTPConnection>(fd, std::string(addr));
+      conn->setLimits(maxHeaderSize, maxBodySize);
+
+      memset(&ev, 0, sizeof(ev));
+      ev.events  = EPOLLIN;
+      ev.data.fd = fd;
+
+      if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        continue; // conn closes the socket
+      }
+
+      connections[fd] = conn;
+    }
+  }
+
+  void HTTPApplication::processInput(ConnectionPtr conn) {
+    HTTPConnection::Message msg;
+    HTTPConnection::ParseResult res;
+    int status;
+
+    /* pipelined requests are answered in order; stop parsing when the client doesn't read its responses */
+    while(!conn->closeAfterWrite() && conn->getOutputBuffer().length() < maxPendingOutput) {
+      status = 400;
+
+      if((res = conn->parseRequest(msg, &status)) == HTTPConnection::ParseIncomplete) {
+        break;
+      }
+
+      if(res == HTTPConnection::ParseError) {
+        msg.keepAlive = false;
+
+        if(msg.protocol.empty()) {
+          msg.protocol = "HTTP/1.1";
+        }
+
+        sendError(conn, msg, status, "ERROR: malformed or unsupported request\012");
+        conn->setCloseAfterWrite();
+        break;
+      }
+
+      handleHTTPRequest(conn, msg);
+
+      if(!msg.keepAlive) {
+        conn->setCloseAfterWrite();
+      }
+    }
+
+    if(conn->hasPendingOutput() && !conn->writeOutput()) {
+      conn->setCloseAfterWrite();
+      conn->getOutputBuffer().clear();
+    }
+  }
+
+  void HTTPApplication::updateConnection(ConnectionPtr conn) {
+    struct epoll_event ev;
+
+    if(conn->closeAfterWrite() && !conn->hasPendingOutput()) {
+      closeConnection(conn);
+      return;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.data.fd = conn->getFd();
+
+    if(!conn->closeAfterWrite() && conn->getOutputBuffer().length() < maxPendingOutput) {
+      ev.events |= EPOLLIN;
+    }
+
+    if(conn->hasPendingOutput()) {
+      ev.events |= EPOLLOUT;
+    }
+
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->getFd(), &ev);
+  }
+
+  void HTTPApplication::closeConnection(ConnectionPtr conn) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->getFd(), NULL);
+    connections.erase(conn->getFd());
+  }
+
+  void HTTPApplication::closeIdleConnections() {
+    std::vector<ConnectionPtr> idle;
+    std::unordered_map<int, ConnectionPtr>::iterator it, end = connections.end();
+    time_t now = time(NULL);
+
+    for(it = connections.begin(); it != end; ++it) {
+      if(now - it->second->getLastActivity() > keepAliveTimeout) {
+        idle.push_back(it->second);
+      }
+    }
+
+    for(std::vector<ConnectionPtr>::iterator c = idle.begin(); c != idle.end(); ++c) {
+      closeConnection(*c);
+    }
+  }
+
+  void HTTPApplication::drainConnections() {
+    std::vector<ConnectionPtr> conns;
+    std::unordered_map<int, ConnectionPtr>::iterator it, end = connections.end();
+
+    for(it = connections.begin(); it != end; ++it) {
+      conns.push_back(it->second);
+    }
+
+    for(std::vector<ConnectionPtr>::iterator c = conns.begin(); c != conns.end(); ++c) {
+      (*c)->setCloseAfterWrite();
+      updateConnection(*c);
+    }
+  }
+
+  void HTTPApplication::handleHTTPRequest(ConnectionPtr conn, const HTTPConnection::Message &msg) {
+    v8::HandleScope scope;
+    size_t mark = conn->getOutputBuffer().length();
+    boost::shared_ptr<HTTPRequest> rq;
+    std::string body, location;
+    int status = 500;
+
+    try {
+      rq = boost::make_shared<HTTPRequest>(msg, *conn, listenPort);
+      run(rq);
+      return;
+    }
+    catch(NotFoundException &e) {
+      std::ostringstream ostr;
+      ostr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")\012";
+      status = 404;
+      body   = ostr.str();
+    }
+    catch(RedirectException &e) {
+      status   = e.getStatus();
+      body     = "You've been redirected to " + e.getUrl() + "\012";
+      location = e.getUrl();
+    }
+    catch(CGIParserException &e) {
+      std::ostringstream ostr;
+      ostr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")\012";
+      status = e.getCode() == CGIParserException::BodyTooLarge || e.getCode() == CGIParserException::FieldTooLarge ? 413 : 400;
+      body   = ostr.str();
+    }
+    catch(CForumException &e) {
+      std::ostringstream ostr;
+      ostr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")\012";
+      body = ostr.str();
+    }
+    catch(std::exception &e) {
+      body = std::string("ERROR: ") + e.what() + "\012";
+    }
+
+    /* part of the response may be sent already; all we can do is cutting it short */
+    if(rq && rq->isCommitted()) {
+      std::cerr << body;
+      conn->setCloseAfterWrite();
+      return;
+    }
+
+    conn->getOutputBuffer().erase(mark);
+    sendError(conn, msg, status, body, location);
+  }
+
+  void HTTPApplication::sendError(ConnectionPtr conn, const HTTPConnection::Message &msg, int status, const std::string &body, const std::string &location) {
+    std::ostringstream ostr;
+
+    ostr << HTTPRequest::statusLine(msg.protocol, status);
+    if(!location.empty()) {
+      ostr << "Location: " << location << "\015\012";
+    }
+    ostr << "Content-Type: text/plain; charset=utf-8\015\012";
+    ostr << "Content-Length: " << body.length() << "\015\012";
+    ostr << "Connection: " << (msg.keepAlive ? "keep-alive" : "close") << "\015\012\015\012";
+
+    if(msg.method != "HEAD") {
+      ostr << body;
+    }
+
+    conn->getOutputBuffer() += ostr.str();
+  }
+
+  HTTPApplication::~HTTPApplication() {
+    connections.clear();
+
+    if(listenSocket != -1) {
+      close(listenSocket);
+    }
+
+    if(listenAddress.compare(0, 5, "unix:") == 0) {
+      unlink(listenAddress.substr(5).c_str());
+    }
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,109 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP application interface; built-in event driven HTTP/1.1 server
+ * \package framework
+ *
+ * The HTTP application listens on a TCP or Unix domain socket and serves
+ * HTTP/1.1 requests (with keep-alive and pipelining) directly, without a
+ * CGI or FastCGI gateway in between
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HTTP_APPLICATION_H
+#define HTTP_APPLICATION_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <csignal>
+#include <cerrno>
+#include <ctime>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "hash_map.hh"
+
+#include "framework/application.hh"
+
+#include "framework/http_connection.hh"
+#include "framework/http_request.hh"
+
+#include "framework/not_found_exception.hh"
+#include "framework/redirect_exception.hh"
+#include "framework/framework_error_exception.hh"
+
+namespace CForum {
+  class HTTPApplication : public Application {
+  public:
+    HTTPApplication();
+    virtual ~HTTPApplication();
+
+    virtual void configure();
+    virtual void handleRequest();
+
+    static void requestShutdown();
+
+  protected:
+    typedef boost::shared_ptr<HTTPConnection> ConnectionPtr;
+
+    virtual void openListenSocket();
+    virtual void acceptConnections();
+    virtual void processInput(ConnectionPtr);
+    virtual void updateConnection(ConnectionPtr);
+    virtual void closeConnection(ConnectionPtr);
+    virtual void closeIdleConnections();
+    virtual void drainConnections();
+
+    virtual void handleHTTPRequest(ConnectionPtr, const HTTPConnection::Message &);
+    virtual void sendError(ConnectionPtr, const HTTPConnection::Message &, int, const std::string &, const std::string & = "");
+
+    int listenSocket, listenPort, epollFd;
+
+    int keepAliveTimeout;
+    size_t maxHeaderSize, maxBodySize, maxPendingOutput;
+
+    std::unordered_map<int, ConnectionPtr> connections;
+
+    static volatile sig_atomic_t shutdownRequested;
+
+  };
+
+}
+
+#endif
+
+/* eof */
@@ -0,0 +1,288 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP connection implementation; buffers and parses HTTP/1.1 requests
+ * \package framework
+ *
+ * A HTTP connection holds the socket of a client, its input and output
+ * buffers and parses HTTP/1.1 requests (including pipelined ones) from the
+ * input buffer
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/http_connection.hh"
+
+namespace CForum {
+  HTTPConnection::Message::Message() : method(), target(), protocol(), body(), headers(), keepAlive(false) { }
+
+  void HTTPConnection::Message::clear() {
+    method.clear();
+    target.clear();
+    protocol.clear();
+    body.clear();
+    headers.clear();
+    keepAlive = false;
+  }
+
+  HTTPConnection::HTTPConnection(int sock, const std::string &remote) : fd(sock), remoteAddress(remote), input(), output(), inputPos(0), outputPos(0), maxHeaderSize(16384), maxBodySize(8388608), closeAfterWriteFlag(false), lastActivity(time(NULL)) { }
+
+  bool HTTPConnection::readInput() {
+    /* no complete request is larger; parseRequest() answers 413 or 431 before we read on */
+    size_t limit = maxHeaderSize + maxBodySize + 1;
+    char buff[8192];
+    ssize_t len;
+
+    /* throw away what we already parsed before appending new data */
+    if(inputPos > 0) {
+      input.erase(0, inputPos);
+      inputPos = 0;
+    }
+
+    for(;;) {
+      if(input.length() >= limit) {
+        return true;
+      }
+
+      len = ::read(fd, buff, std::min(sizeof(buff), limit - input.length()));
+
+      if(len > 0) {
+        input.append(buff, len);
+        lastActivity = time(NULL);
+        continue;
+      }
+
+      if(len == 0) {
+        return false;
+      }
+
+      if(errno == EINTR) {
+        continue;
+      }
+
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+  }
+
+  bool HTTPConnection::writeOutput() {
+    ssize_t len;
+
+    while(outputPos < output.length()) {
+      len = send(fd, output.data() + outputPos, output.length() - outputPos, MSG_NOSIGNAL);
+
+      if(len < 0) {
+        if(errno == EINTR) {
+          continue;
+        }
+
+        break;
+      }
+
+      outputPos += len;
+      lastActivity = time(NULL);
+    }
+
+    if(outputPos < output.length() && errno != EAGAIN && errno != EWOULDBLOCK) {
+      return false;
+    }
+
+    /* keep only what is still to be sent */
+    output.erase(0, outputPos);
+    outputPos = 0;
+
+    return true;
+  }
+
+  bool HTTPConnection::sendResponse(ResponseWriter &response) {
+    ssize_t len = 0;
+
+    /* responses must not overtake what's still queued */
+    if(!hasPendingOutput()) {
+      if((len = response.writeTo(fd)) < 0) {
+        response.clear();
+        return false;
+      }
+
+      if(len > 0) {
+        lastActivity = time(NULL);
+      }
+    }
+
+    response.appendTo(output);
+    response.clear();
+
+    return true;
+  }
+
+  static inline std::string trim(const std::string &str) {
+    size_t start = str.find_first_not_of(" \t"), end = str.find_last_not_of(" \t\015");
+
+    if(start == std::string::npos) {
+      return std::string();
+    }
+
+    return str.substr(start, end - start + 1);
+  }
+
+  static inline bool caseEquals(const std::string &a, const char *b) {
+    return strcasecmp(a.c_str(), b) == 0;
+  }
+
+  HTTPConnection::ParseResult HTTPConnection::parseRequest(Message &msg, int *status) {
+    size_t pos = inputPos, eol, sep, header_end, content_length = 0;
+    bool keep_alive_given = false, close_given = false, length_given = false;
+    std::string line, name, value;
+
+    msg.clear();
+
+    /* RFC 2616, 4.1: servers SHOULD ignore empty lines before the request line */
+    while(pos < input.length() && (input[pos] == '\015' || input[pos] == '\012')) {
+      ++pos;
+    }
+
+    /* they don't count against the limits */
+    inputPos = pos;
+
+    /* find the end of the header block, while checking the header size limit */
+    for(header_end = pos; ; header_end = eol + 1) {
+      if((eol = input.find('\012', header_end)) == std::string::npos) {
+        if(input.length() - pos > maxHeaderSize) {
+          *status = 431;
+          return ParseError;
+        }
+
+        return ParseIncomplete;
+      }
+
+      if(eol == header_end || (eol == header_end + 1 && input[header_end] == '\015')) {
+        break;
+      }
+    }
+
+    if(eol - pos > maxHeaderSize) {
+      *status = 431;
+      return ParseError;
+    }
+
+    /* request line: method SP request-target SP HTTP-version */
+    eol  = input.find('\012', pos);
+    line = trim(input.substr(pos, eol - pos));
+
+    if((sep = line.find(' ')) == std::string::npos) {
+      *status = 400;
+      return ParseError;
+    }
+
+    msg.method = line.substr(0, sep);
+    line       = trim(line.substr(sep + 1));
+
+    if((sep = line.rfind(' ')) == std::string::npos) {
+      *status = 400;
+      return ParseError;
+    }
+
+    msg.target   = line.substr(0, sep);
+    msg.protocol = line.substr(sep + 1);
+
+    if(msg.protocol != "HTTP/1.1" && msg.protocol != "HTTP/1.0") {
+      *status = 505;
+      return ParseError;
+    }
+
+    /* header fields */
+    for(pos = eol + 1; pos < header_end; pos = eol + 1) {
+      eol  = input.find('\012', pos);
+      line = input.substr(pos, eol - pos);
+
+      if((sep = line.find(':')) == std::string::npos || sep == 0) {
+        *status = 400;
+        return ParseError;
+      }
+
+      name  = line.substr(0, sep);
+      value = trim(line.substr(sep + 1));
+
+      /* "Content-Length : 5" must not slip past us as an unknown header (RFC 7230, 3.2.4) */
+      if(name.find_first_of(" \t") != std::string::npos) {
+        *status = 400;
+        return ParseError;
+      }
+
+      if(caseEquals(name, "Content-Length")) {
+        /* a proxy in front of us may pick another one than we do: no second one, no sign, no list */
+        if(length_given || value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+          *status = 400;
+          return ParseError;
+        }
+
+        content_length = strtoul(value.c_str(), NULL, 10);
+        length_given   = true;
+      }
+      else if(caseEquals(name, "Transfer-Encoding") && !caseEquals(value, "identity")) {
+        /* we don't support chunked request bodies (yet) */
+        *status = 411;
+        return ParseError;
+      }
+      else if(caseEquals(name, "Connection")) {
+        if(strcasestr(value.c_str(), "close") != NULL) {
+          close_given = true;
+        }
+        else if(strcasestr(value.c_str(), "keep-alive") != NULL) {
+          keep_alive_given = true;
+        }
+      }
+
+      msg.headers.push_back(std::make_pair(name, value));
+    }
+
+    if(content_length > maxBodySize) {
+      *status = 413;
+      return ParseError;
+    }
+
+    /* skip the empty line finishing the header block */
+    pos = input.find('\012', header_end) + 1;
+
+    if(input.length() - pos < content_length) {
+      return ParseIncomplete;
+    }
+
+    msg.body.assign(input, pos, content_length);
+    inputPos = pos + content_length;
+
+    if(msg.protocol == "HTTP/1.1") {
+      msg.keepAlive = !close_given;
+    }
+    else {
+      msg.keepAlive = keep_alive_given && !close_given;
+    }
+
+    return ParseComplete;
+  }
+
+  HTTPConnection::~HTTPConnection() {
+    close(fd);
+  }
+
+}
+
+/* eof */
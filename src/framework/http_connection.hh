@@ -0,0 +1,148 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP connection interface; buffers and parses HTTP/1.1 requests
+ * \package framework
+ *
+ * A HTTP connection holds the socket of a client, its input and output
+ * buffers and parses HTTP/1.1 requests (including pipelined ones) from the
+ * input buffer
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HTTP_CONNECTION_H
+#define HTTP_CONNECTION_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <ctime>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "framework/response_writer.hh"
+
+namespace CForum {
+  class HTTPConnection {
+  public:
+    class Message {
+    public:
+      Message();
+
+      void clear();
+
+      std::string method, target, protocol, body;
+      std::vector<std::pair<std::string, std::string> > headers;
+      bool keepAlive;
+    };
+
+    enum ParseResult {
+      ParseIncomplete,
+      ParseComplete,
+      ParseError
+    };
+
+    HTTPConnection(int, const std::string &);
+    ~HTTPConnection();
+
+    int getFd() const;
+    const std::string &getRemoteAddress() const;
+
+    bool readInput();
+    bool writeOutput();
+    bool sendResponse(ResponseWriter &);
+
+    ParseResult parseRequest(Message &, int *);
+
+    std::string &getOutputBuffer();
+    bool hasPendingOutput() const;
+
+    void setLimits(size_t, size_t);
+
+    void setCloseAfterWrite();
+    bool closeAfterWrite() const;
+
+    time_t getLastActivity() const;
+
+  protected:
+    int fd;
+    std::string remoteAddress;
+
+    std::string input, output;
+    size_t inputPos, outputPos;
+
+    size_t maxHeaderSize, maxBodySize;
+
+    bool closeAfterWriteFlag;
+    time_t lastActivity;
+
+  private:
+    HTTPConnection(const HTTPConnection &);
+    HTTPConnection &operator=(const HTTPConnection &);
+  };
+
+  inline int HTTPConnection::getFd() const {
+    return fd;
+  }
+
+  inline const std::string &HTTPConnection::getRemoteAddress() const {
+    return remoteAddress;
+  }
+
+  inline std::string &HTTPConnection::getOutputBuffer() {
+    return output;
+  }
+
+  inline bool HTTPConnection::hasPendingOutput() const {
+    return outputPos < output.length();
+  }
+
+  inline void HTTPConnection::setLimits(size_t max_header, size_t max_body) {
+    maxHeaderSize = max_header;
+    maxBodySize   = max_body;
+  }
+
+  inline void HTTPConnection::setCloseAfterWrite() {
+    closeAfterWriteFlag = true;
+  }
+
+  inline bool HTTPConnection::closeAfterWrite() const {
+    return closeAfterWriteFlag;
+  }
+
+  inline time_t HTTPConnection::getLastActivity() const {
+    return lastActivity;
+  }
+
+}
+
+#endif
+
+/* eof */
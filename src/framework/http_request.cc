@@ -0,0 +1,268 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP request implementation; request coming from the built-in HTTP server
+ * \package framework
+ *
+ * A HTTP request is a request received directly by the built-in HTTP
+ * server; it builds the CGI containers from the parsed HTTP message and
+ * generates a complete HTTP response
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/http_request.hh"
+
+namespace CForum {
+  class StringInput : public CGI::Input {
+  public:
+    StringInput(const std::string &str) : data(str), pos(0) { }
+
+    virtual size_t read(char *buff, size_t len) {
+      if(len > data.length() - pos) {
+        len = data.length() - pos;
+      }
+
+      memcpy(buff, data.data() + pos, len);
+      pos += len;
+
+      return len;
+    }
+
+  private:
+    const std::string &data;
+    size_t pos;
+  };
+
+  static std::string headerToVariable(const std::string &name) {
+    std::string var = "HTTP_";
+
+    for(std::string::const_iterator it = name.begin(); it != name.end(); ++it) {
+      var += *it == '-' ? '_' : (char)toupper((unsigned char)*it);
+    }
+
+    return var;
+  }
+
+  CGI HTTPRequest::fromHTTPMessage(const HTTPConnection::Message &msg, const std::string &remote_addr, int port) {
+    std::vector<std::string> env;
+    std::vector<const char *> envp;
+    std::vector<std::pair<std::string, std::string> >::const_iterator it, end = msg.headers.end();
+    std::string path = msg.target, query, host, server_port, decoded;
+    size_t pos;
+
+    std::ostringstream ostr;
+    ostr << port;
+    server_port = ostr.str();
+
+    if((pos = path.find('?')) != std::string::npos) {
+      query = path.substr(pos + 1);
+      path.erase(pos);
+    }
+
+    /* absolute-form request targets (RFC 2616, 5.1.2) */
+    if(path.compare(0, 7, "http://") == 0 || path.compare(0, 8, "https://") == 0) {
+      pos  = path.find('/', path.find("//") + 2);
+      path = pos == std::string::npos ? "/" : path.substr(pos);
+    }
+
+    CGI::decode(path).toUTF8String(decoded);
+
+    env.push_back("GATEWAY_INTERFACE=CGI/1.1");
+    env.push_back("SERVER_SOFTWARE=cforum/" CF_VERSION);
+    env.push_back("SERVER_PROTOCOL=" + msg.protocol);
+    env.push_back("REQUEST_METHOD=" + msg.method);
+    env.push_back("PATH_INFO=" + decoded);
+    env.push_back("QUERY_STRING=" + query);
+    env.push_back("REMOTE_ADDR=" + remote_addr);
+
+    for(it = msg.headers.begin(); it != end; ++it) {
+      if(strcasecmp(it->first.c_str(), "Content-Type") == 0) {
+        env.push_back("CONTENT_TYPE=" + it->second);
+      }
+      else if(strcasecmp(it->first.c_str(), "Content-Length") == 0) {
+        env.push_back("CONTENT_LENGTH=" + it->second);
+      }
+      else {
+        if(strcasecmp(it->first.c_str(), "Host") == 0) {
+          host = it->second;
+        }
+
+        env.push_back(headerToVariable(it->first) + "=" + it->second);
+      }
+    }
+
+    if((pos = host.rfind(':')) != std::string::npos && host.find(']', pos) == std::string::npos) {
+      server_port = host.substr(pos + 1);
+      host.erase(pos);
+    }
+
+    env.push_back("SERVER_NAME=" + host);
+    env.push_back("SERVER_PORT=" + server_port);
+
+    for(std::vector<std::string>::const_iterator e = env.begin(); e != env.end(); ++e) {
+      envp.push_back(e->c_str());
+    }
+    envp.push_back(NULL);
+
+    StringInput in(msg.body);
+    return CGI::fromEnvironment(&envp[0], &in);
+  }
+
+  HTTPRequest::HTTPRequest(const HTTPConnection::Message &msg, HTTPConnection &conn, int port) : CGIRequest(fromHTTPMessage(msg, conn.getRemoteAddress(), port)), connection(conn), protocol(msg.protocol), keepAlive(msg.keepAlive), headRequest(msg.method == "HEAD"), chunked(false), bodyless(false) { }
+
+  const char *HTTPRequest::reasonPhrase(int status) {
+    switch(status) {
+      case 200: return "OK";
+      case 301: return "Moved Permanently";
+      case 302: return "Found";
+      case 303: return "See Other";
+      case 304: return "Not Modified";
+      case 307: return "Temporary Redirect";
+      case 400: return "Bad Request";
+      case 403: return "Forbidden";
+      case 404: return "Not Found";
+      case 411: return "Length Required";
+      case 413: return "Request Entity Too Large";
+      case 431: return "Request Header Fields Too Large";
+      case 500: return "Internal Server Error";
+      case 505: return "HTTP Version Not Supported";
+      default:  return "Unknown";
+    }
+  }
+
+  std::string HTTPRequest::statusLine(const std::string &proto, int status) {
+    std::ostringstream ostr;
+    ostr << proto << " " << status << " " << reasonPhrase(status) << "\015\012";
+    return ostr.str();
+  }
+
+  static inline size_t trimmedLength(const std::string &val) {
+    size_t len = val.length();
+
+    while(len > 0 && (val[len - 1] == '\012' || val[len - 1] == '\015')) {
+      --len;
+    }
+
+    return len;
+  }
+
+  void HTTPRequest::sendHeaders() {
+    std::unordered_map<std::string, std::string>::const_iterator it, end = headers.end();
+    std::string status = "200 OK";
+    bool had_ct = false;
+    char buff[64];
+    size_t len;
+
+    /* the CGI status header becomes the HTTP status line */
+    for(it = headers.begin(); it != end; ++it) {
+      if(strcasecmp(it->first.c_str(), "status") == 0) {
+        status = it->second.substr(0, trimmedLength(it->second));
+
+        if(status.find(' ') == std::string::npos) {
+          status += std::string(" ") + reasonPhrase(atoi(status.c_str()));
+        }
+      }
+    }
+
+    response.addCopy(protocol + " " + status + "\015\012");
+
+    for(it = headers.begin(); it != end; ++it) {
+      const char *nam = it->first.c_str();
+
+      /* we handle status and framing ourselves */
+      if(strcasecmp(nam, "status") == 0 || strcasecmp(nam, "content-length") == 0 || strcasecmp(nam, "connection") == 0 || strcasecmp(nam, "transfer-encoding") == 0) {
+        continue;
+      }
+
+      if(strcasecmp(nam, "content-type") == 0) {
+        had_ct = true;
+      }
+
+      response.add(it->first);
+      response.add(": ", 2);
+      response.add(it->second.data(), trimmedLength(it->second));
+      response.add("\015\012", 2);
+    }
+
+    if(!had_ct) {
+      response.add("Content-Type: text/html; charset=utf-8\015\012");
+    }
+
+    /* 304 and 204 end with the headers, whatever the controller did */
+    if(isBodyless()) {
+      bodyless = true;
+    }
+    else if(contentLength >= 0) {
+      len = (size_t)snprintf(buff, sizeof(buff), "Content-Length: %ld\015\012", contentLength);
+      response.addCopy(buff, len);
+    }
+    else if(protocol == "HTTP/1.1") {
+      response.add("Transfer-Encoding: chunked\015\012");
+      chunked = true;
+    }
+    else {
+      /* a HTTP/1.0 client only knows the body is complete when we close */
+      keepAlive = false;
+      connection.setCloseAfterWrite();
+    }
+
+    response.add(keepAlive ? "Connection: keep-alive\015\012\015\012" : "Connection: close\015\012\015\012");
+  }
+
+  void HTTPRequest::sendBody(const char *buff, size_t len) {
+    char size[32];
+
+    if(!headRequest && !bodyless && len > 0) {
+      if(chunked) {
+        response.addCopy(size, (size_t)snprintf(size, sizeof(size), "%lx\015\012", (unsigned long)len));
+        response.add(buff, len);
+        response.add("\015\012", 2);
+      }
+      else {
+        response.add(buff, len);
+      }
+    }
+
+    writeResponse();
+  }
+
+  void HTTPRequest::endBody() {
+    if(chunked && !headRequest && !bodyless) {
+      response.add("0\015\012\015\012", 5);
+    }
+
+    writeResponse();
+  }
+
+  /* straight to the socket if nothing is queued; the connection keeps what didn't fit */
+  void HTTPRequest::writeResponse() {
+    if(!connection.sendResponse(response)) {
+      connection.setCloseAfterWrite();
+    }
+  }
+
+  HTTPRequest::~HTTPRequest() { }
+
+}
+
+/* eof */
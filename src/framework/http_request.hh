@@ -0,0 +1,76 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP request interface; request coming from the built-in HTTP server
+ * \package framework
+ *
+ * A HTTP request is a request received directly by the built-in HTTP
+ * server; it builds the CGI containers from the parsed HTTP message and
+ * generates a complete HTTP response
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HTTP_REQUEST_H
+#define HTTP_REQUEST_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <cctype>
+#include <cstdio>
+
+#include "framework/cgi_request.hh"
+#include "framework/http_connection.hh"
+
+namespace CForum {
+  class HTTPRequest : public CGIRequest {
+  public:
+    HTTPRequest(const HTTPConnection::Message &, HTTPConnection &, int);
+    virtual ~HTTPRequest();
+
+    static CGI fromHTTPMessage(const HTTPConnection::Message &, const std::string &, int);
+    static std::string statusLine(const std::string &, int);
+    static const char *reasonPhrase(int);
+
+  protected:
+    virtual void writeResponse();
+
+    virtual void sendHeaders();
+    virtual void sendBody(const char *, size_t);
+    virtual void endBody();
+
+    HTTPConnection &connection;
+    std::string protocol;
+    bool keepAlive, headRequest, chunked, bodyless;
+
+  private:
+    HTTPRequest(const HTTPRequest &);
+    HTTPRequest &operator=(const HTTPRequest &);
+  };
+
+}
+
+#endif
+
+/* eof */
@@ -43,6 +43,8 @@ namespace CForum {
 
     static const int NoOutputGeneratedError = 0x4efb1370;
     static const int CouldNotGetTimeError   = 0x4eff24f6;
+    static const int HeadersSentError       = 0x4fe7b1c2;
+    static const int UnknownUrlError        = 0x4feb6a91;
   };
 
 }
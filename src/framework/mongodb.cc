@@ -41,6 +41,11 @@ namespace CForum {
     std::string ns_w_db = dbname + "." + ns;
     return mongo::DBClientConnection::query(ns_w_db, query, nToReturn, nToSkip, fieldsToReturn, queryOptions, batchSize);
   }
+
+  void DBClientConnection::update(const std::string &ns, mongo::Query query, mongo::BSONObj obj, bool upsert, bool multi) {
+    std::string ns_w_db = dbname + "." + ns;
+    mongo::DBClientConnection::update(ns_w_db, query, obj, upsert, multi);
+  }
 }
 
 /* eof */
@@ -42,6 +42,7 @@ namespace CForum {
 
     virtual void setDbName(const std::string &);
     virtual std::auto_ptr<mongo::DBClientCursor> query(const std::string &, mongo::Query = mongo::Query(), int = 0, int = 0, const mongo::BSONObj * = 0, int = 0, int = 0);
+    virtual void update(const std::string &, mongo::Query, mongo::BSONObj, bool = false, bool = false);
 
   protected:
     std::string dbname;
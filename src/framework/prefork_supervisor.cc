@@ -0,0 +1,209 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Prefork supervisor implementation; forks and supervises worker processes
+ * \package framework
+ *
+ * The prefork supervisor runs in the master process after the application
+ * has been configured and forks worker processes sharing the listen socket;
+ * it respawns crashed workers and replaces recycled ones
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/prefork_supervisor.hh"
+
+namespace CForum {
+  volatile sig_atomic_t PreforkSupervisor::shutdownRequested = 0;
+
+  static void supervisorShutdownHandler(int) {
+    PreforkSupervisor::requestShutdown();
+  }
+
+  static void supervisorChildHandler(int) { }
+
+  PreforkSupervisor::PreforkSupervisor(Application *application) : app(application), workers(), spawned(0), workerCount(0), maxRequests(0), maxRss(0) {
+    readConfig();
+  }
+
+  void PreforkSupervisor::requestShutdown() {
+    shutdownRequested = 1;
+  }
+
+  void PreforkSupervisor::readConfig() {
+    boost::shared_ptr<Configparser> cfg = app->getConfigparser();
+
+    workerCount = (int)cfg->getNode("system/workers/count").asInt();
+    maxRequests = (unsigned long)cfg->getNode("system/workers/max-requests").asInt();
+    maxRss      = (size_t)cfg->getNode("system/workers/max-rss").asInt();
+  }
+
+  void PreforkSupervisor::run() {
+    struct sigaction sa;
+
+    app->setWorkerLimits(maxRequests, maxRss);
+    app->watchConfig();
+
+    /* no workers configured: serve from this process like we always did */
+    if(workerCount <= 0) {
+      app->initWorker();
+      app->handleRequest();
+      return;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = supervisorShutdownHandler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    /* dying workers shall interrupt our wait for config changes */
+    sa.sa_handler = supervisorChildHandler;
+    sigaction(SIGCHLD, &sa, NULL);
+
+    while(!shutdownRequested && (int)workers.size() < workerCount) {
+      spawnWorker();
+    }
+
+    spawned = time(NULL);
+
+    while(!shutdownRequested) {
+      reapWorkers();
+
+      /* workers are forked from our state, so replacing them publishes a reload */
+      if(!shutdownRequested && app->waitForReload(1000) && app->reload()) {
+        recycleWorkers();
+      }
+    }
+
+    stopWorkers();
+  }
+
+  void PreforkSupervisor::reapWorkers() {
+    pid_t pid;
+    int status;
+
+    while(!shutdownRequested && (pid = waitpid(-1, &status, WNOHANG)) > 0) {
+      if(workers.erase(pid) == 0) {
+        continue;
+      }
+
+      if(WIFSIGNALED(status) || (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS)) {
+        std::cerr << "worker " << pid << " died unexpectedly (status " << status << "), respawning" << std::endl;
+
+        /* don't fork like mad when workers die right after startup */
+        if(time(NULL) == spawned) {
+          sleep(1);
+        }
+      }
+
+      if(!shutdownRequested) {
+        spawnWorker();
+        spawned = time(NULL);
+      }
+    }
+  }
+
+  void PreforkSupervisor::recycleWorkers() {
+    std::set<pid_t>::iterator it;
+
+    /* they finish their current requests and are respawned by reapWorkers() */
+    for(it = workers.begin(); it != workers.end(); ++it) {
+      kill(*it, SIGTERM);
+    }
+  }
+
+  void PreforkSupervisor::spawnWorker() {
+    pid_t pid = fork();
+
+    if(pid == -1) {
+      throw FrameworkErrorException(std::string("Error forking worker: ") + strerror(errno), FrameworkErrorException::WorkerError);
+    }
+
+    if(pid == 0) {
+      runWorker();
+    }
+
+    workers.insert(pid);
+  }
+
+  void PreforkSupervisor::runWorker() {
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_DFL;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGCHLD, &sa, NULL);
+
+    /* reloads are the master's business */
+    app->stopWatchingConfig();
+
+    /*
+     * the worker owns a copy of the V8 heap and modules set up by the master;
+     * the database connection however must not be shared
+     */
+    try {
+      app->initWorker();
+      app->handleRequest();
+    }
+    catch(CForumException &e) {
+      std::cerr << "ERROR: " << e.getMessage() << " (" << std::hex << e.getCode() << std::dec << ")" << std::endl;
+      _exit(EXIT_FAILURE);
+    }
+    catch(std::exception &e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      _exit(EXIT_FAILURE);
+    }
+
+    _exit(EXIT_SUCCESS);
+  }
+
+  void PreforkSupervisor::stopWorkers() {
+    std::set<pid_t>::iterator it;
+    int status;
+
+    for(it = workers.begin(); it != workers.end(); ++it) {
+      kill(*it, SIGTERM);
+    }
+
+    while(!workers.empty()) {
+      pid_t pid = waitpid(-1, &status, 0);
+
+      if(pid == -1) {
+        if(errno == EINTR) {
+          continue;
+        }
+
+        break;
+      }
+
+      workers.erase(pid);
+    }
+  }
+
+  PreforkSupervisor::~PreforkSupervisor() { }
+
+}
+
+/* eof */
@@ -0,0 +1,96 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Prefork supervisor interface; forks and supervises worker processes
+ * \package framework
+ *
+ * The prefork supervisor runs in the master process after the application
+ * has been configured and forks worker processes sharing the listen socket;
+ * it respawns crashed workers and replaces recycled ones
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PREFORK_SUPERVISOR_H
+#define PREFORK_SUPERVISOR_H
+
+#include <set>
+
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <iostream>
+
+#include "framework/application.hh"
+#include "framework/framework_error_exception.hh"
+
+namespace CForum {
+  class PreforkSupervisor {
+  public:
+    PreforkSupervisor(Application *);
+    virtual ~PreforkSupervisor();
+
+    virtual void run();
+
+    int getWorkerCount() const;
+
+    static void requestShutdown();
+
+  protected:
+    virtual void readConfig();
+    virtual void spawnWorker();
+    virtual void runWorker();
+    virtual void stopWorkers();
+    virtual void recycleWorkers();
+    virtual void reapWorkers();
+
+    Application *app;
+    std::set<pid_t> workers;
+    time_t spawned;
+
+    int workerCount;
+    unsigned long maxRequests;
+    size_t maxRss;
+
+    static volatile sig_atomic_t shutdownRequested;
+
+  private:
+    PreforkSupervisor(const PreforkSupervisor &);
+    PreforkSupervisor &operator=(const PreforkSupervisor &);
+  };
+
+  inline int PreforkSupervisor::getWorkerCount() const {
+    return workerCount;
+  }
+
+}
+
+#endif
+
+/* eof */
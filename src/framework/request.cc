@@ -31,6 +31,14 @@
 #include "framework/request.hh"
 
 namespace CForum {
+  static ConfigValueCache *configValueCache(v8::Local<v8::Object> self) {
+    if(self->InternalFieldCount() < 2) {
+      return NULL;
+    }
+
+    return reinterpret_cast<ConfigValueCache *>(v8::Local<v8::External>::Cast(self->GetInternalField(1))->Value());
+  }
+
   static v8::Handle<v8::Value> _getCfg(const v8::Arguments &args) {
     v8::Local<v8::Object> self = args.Holder();
 
@@ -40,6 +48,7 @@ namespace CForum {
 
     v8::Local<v8::External> wrap = v8::Local<v8::External>::Cast(self->GetInternalField(0));
     Configparser *cfg = reinterpret_cast<Configparser *>(wrap->Value());
+    ConfigValueCache *cache = configValueCache(self);
 
     if(cfg == NULL) {
       return v8::ThrowException(v8::String::New("Oops! Configparser object is NULL."));
@@ -58,7 +67,7 @@ namespace CForum {
     v8::Local<v8::Value> ret;
 
     try {
-      return cfg->getValue(*nam, may_be_null);
+      return cfg->getValue(*nam, may_be_null, cache);
     }
     catch(ConfigErrorException &e) {
       return v8::ThrowException(v8::String::New("Config value is null!"));
@@ -76,6 +85,7 @@ namespace CForum {
 
     v8::Local<v8::External> wrap = v8::Local<v8::External>::Cast(self->GetInternalField(0));
     Configparser *cfg = reinterpret_cast<Configparser *>(wrap->Value());
+    ConfigValueCache *cache = configValueCache(self);
 
     if(cfg == NULL) {
       return v8::ThrowException(v8::String::New("Oops! Configparser object is NULL."));
@@ -95,7 +105,7 @@ namespace CForum {
     v8::Local<v8::Value> ret;
 
     try {
-      return cfg->getByPath(*nam, may_be_null);
+      return cfg->getByPath(*nam, may_be_null, cache);
     }
     catch(ConfigErrorException &e) {
       return v8::ThrowException(v8::String::New("Config value is null!"));
@@ -106,70 +116,224 @@ namespace CForum {
 
 
 
-  Request::Request() : requestUri(), user(), tpl() { }
-  Request::Request(const Request &rq) : requestUri(rq.requestUri), user(rq.user), tpl(rq.tpl) { }
+  Request::OutputBuffer::OutputBuffer(Request *rq) : std::streambuf(), request(rq) {
+    setp(buffer, buffer + ChunkSize);
+  }
 
-  void Request::initTemplate(boost::shared_ptr<Configparser> configparser) {
-    v8::Local<v8::Value> exts = configparser->getByPath("system/views-js");
-    v8::Local<v8::Object> extensions;
-    v8::Local<v8::Array> keys;
-    v8::Local<v8::String> file, name;
-    uint32_t i, len;
+  void Request::OutputBuffer::flushBuffer() {
+    size_t len = pptr() - pbase();
 
-    if(!exts->IsNull() && !exts->IsUndefined()) {
-      extensions = exts->ToObject();
-      keys = extensions->GetPropertyNames();
-      char **extension_names = new char *[keys->Length()];
+    if(len > 0) {
+      request->commit();
+      request->writeBody(pbase(), len);
+    }
 
-      for(len = keys->Length(), i = 0; i < len; ++i) {
-        name = keys->Get(i)->ToString();
-        file = extensions->Get(name)->ToString();
-        v8::String::Utf8Value name_c(name);
-        v8::String::Utf8Value file_c(file);
+    setp(buffer, buffer + ChunkSize);
+  }
 
-        std::ifstream fd(*file_c, std::ifstream::in);
-        std::stringstream sst;
+  Request::OutputBuffer::int_type Request::OutputBuffer::overflow(int_type c) {
+    flushBuffer();
 
-        if(!fd) {
-          throw InternalErrorException(std::string("File ") + *file_c + " could not be found!", CForumErrorException::FileNotFound);
-        }
+    if(!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
 
-        sst << fd.rdbuf();
-        fd.close();
+    return traits_type::not_eof(c);
+  }
 
-        char *nam = strdup(*name_c);
-        v8::RegisterExtension(new v8::Extension(nam, strdup(sst.str().c_str())));
-        extension_names[i] = nam;
+  std::streamsize Request::OutputBuffer::xsputn(const char *str, std::streamsize len) {
+    if(len > epptr() - pptr()) {
+      flushBuffer();
+
+      /* no need to copy what fills whole chunks anyway */
+      if((size_t)len >= ChunkSize) {
+        request->commit();
+        request->writeBody(str, (size_t)len);
+        return len;
       }
+    }
 
-      v8::ExtensionConfiguration *extensions = new v8::ExtensionConfiguration((int)len, const_cast<const char **>(extension_names));
-      tpl = boost::make_shared<Template>(extensions);
+    memcpy(pptr(), str, (size_t)len);
+    pbump((int)len);
+
+    return len;
+  }
+
+  int Request::OutputBuffer::sync() {
+    flushBuffer();
+    return 0;
+  }
+
+  Request::Request() : requestUri(), requestMethod(), user(), configparser(), tpl(), headers(), committed(false), finished(false), encodingSelected(false), contentLength(-1), outputBuffer(), outputStream(), compression(ResponseCompressor::getSettings()), compressor(), immutableKey(), compressedBody(), etag(), lastModified(0), capture() { }
+  Request::Request(const Request &rq) : requestUri(rq.requestUri), requestMethod(rq.requestMethod), user(rq.user), configparser(rq.configparser), tpl(rq.tpl), headers(), committed(false), finished(false), encodingSelected(false), contentLength(-1), outputBuffer(), outputStream(), compression(rq.compression), compressor(), immutableKey(), compressedBody(), etag(), lastModified(0), capture() { }
+
+  std::ostream &Request::getOutputStream() {
+    if(!outputStream) {
+      outputBuffer = boost::make_shared<OutputBuffer>(this);
+      outputStream = boost::make_shared<std::ostream>(outputBuffer.get());
+    }
+
+    return *outputStream;
+  }
+
+  void Request::commit() {
+    if(!committed) {
+      selectEncoding();
+
+      committed = true;
+      sendHeaders();
+    }
+  }
+
+  void Request::finish() {
+    std::string tail;
+
+    if(finished) {
+      return;
+    }
+
+    if(outputStream) {
+      outputStream->flush();
+    }
+
+    commit();
+
+    if(compressor && !compressor->isFinished()) {
+      compressBody(NULL, 0, true, tail);
+      sendBody(tail.data(), tail.length());
+    }
+
+    if(compressor && !immutableKey.empty()) {
+      ResponseCompressor::storePrecompressed(immutableKey, compressor->getEncoding(), compressedBody);
+    }
+
+    endBody();
+
+    finished = true;
+  }
+
+  void Request::endBody() { }
+
+  void Request::selectEncoding() {
+    encodingSelected = true;
+  }
+
+  void Request::compressBody(const char *buff, size_t len, bool last, std::string &out) {
+    compressor->compress(buff, len, last, out);
+
+    if(!immutableKey.empty()) {
+      compressedBody += out;
+    }
+  }
+
+  void Request::writeBody(const char *buff, size_t len) {
+    std::string packed;
+
+    if(capture) {
+      capture->append(buff, len);
+    }
+
+    if(!compressor) {
+      sendBody(buff, len);
+      return;
+    }
+
+    compressBody(buff, len, false, packed);
+    sendBody(packed.data(), packed.length());
+  }
+
+  const std::string *Request::findHeader(const char *name) const {
+    std::unordered_map<std::string, std::string>::const_iterator it, end = headers.end();
+
+    for(it = headers.begin(); it != end; ++it) {
+      if(strcasecmp(it->first.c_str(), name) == 0) {
+        return &it->second;
+      }
+    }
+
+    return NULL;
+  }
+
+  bool Request::isBodyless() const {
+    const std::string *status = findHeader("Status");
+    return status != NULL && (status->compare(0, 3, "304") == 0 || status->compare(0, 3, "204") == 0);
+  }
+
+  void Request::setImmutable(const std::string &key) {
+    immutableKey = key;
+  }
+
+  bool Request::sendPrecompressed(const std::string &key) {
+    boost::shared_ptr<const std::string> body;
+
+    if(committed) {
+      return false;
+    }
+
+    selectEncoding();
+
+    if(!compressor || !(body = ResponseCompressor::getPrecompressed(key, compressor->getEncoding()))) {
+      return false;
+    }
+
+    /* the body is complete already, nothing left to compress */
+    compressor.reset();
+    immutableKey.clear();
+
+    contentLength = (long)body->length();
+    commit();
+    sendBody(body->data(), body->length());
+
+    return true;
+  }
+
+  v8::Local<v8::ObjectTemplate> Request::createConfigparserTemplate() {
+    v8::Local<v8::ObjectTemplate> templ = v8::ObjectTemplate::New();
+
+    templ->SetInternalFieldCount(2);
+    templ->Set(v8::String::New("get"), v8::FunctionTemplate::New(_getCfg));
+    templ->Set(v8::String::New("getByPath"), v8::FunctionTemplate::New(_getByPathCfg));
+
+    return templ;
+  }
+
+  void Request::initTemplate(boost::shared_ptr<Configparser> cfg, boost::shared_ptr<TemplatePool> pool, v8::Handle<v8::ObjectTemplate> cfgparser_templ, ConfigValueCache *cache) {
+    configparser = cfg;
+
+    if(pool) {
+      tpl = pool->acquire();
     }
     else {
       tpl = boost::make_shared<Template>();
     }
 
-
-    v8::Handle<v8::ObjectTemplate> cfgparser_templ = v8::ObjectTemplate::New();
-    cfgparser_templ->SetInternalFieldCount(1);
-    cfgparser_templ->Set(v8::String::New("get"), v8::FunctionTemplate::New(_getCfg));
-    cfgparser_templ->Set(v8::String::New("getByPath"), v8::FunctionTemplate::New(_getByPathCfg));
+    if(cfgparser_templ.IsEmpty()) {
+      cfgparser_templ = createConfigparserTemplate();
+    }
 
     v8::Local<v8::Object> obj = cfgparser_templ->NewInstance();
     obj->SetInternalField(0, v8::External::New(configparser.get()));
+    obj->SetInternalField(1, v8::External::New(cache));
     tpl->setGlobal("configparser", obj);
   }
 
   Request &Request::operator=(const Request &rq) {
     if(this != &rq) {
-      requestUri = rq.requestUri;
-      user       = rq.user;
+      requestUri    = rq.requestUri;
+      requestMethod = rq.requestMethod;
+      user          = rq.user;
     }
 
     return *this;
   }
 
   void Request::setHeader(const std::string &name, const std::string &value) {
+    /* too late, they are on the wire */
+    if(committed) {
+      throw InternalErrorException("Headers have already been sent", InternalErrorException::HeadersSentError);
+    }
+
     headers[name] = value;
   }
 
@@ -37,17 +37,52 @@
 #include <boost/make_shared.hpp>
 
 #include <string>
+#include <ostream>
+#include <streambuf>
+
+#include <cstring>
+#include <ctime>
+#include <strings.h>
 
 #include "cgi/cgi.hh"
 #include "framework/configparser.hh"
 #include "framework/uri.hh"
 #include "framework/user.hh"
 #include "template/template.hh"
+#include "template/template_pool.hh"
 #include "framework/internal_error_exception.hh"
+#include "framework/response_compressor.hh"
 
 namespace CForum {
   class Request {
   public:
+    /**
+     * Collects the body in chunks and hands each full chunk to the request;
+     * the first chunk commits the headers
+     */
+    class OutputBuffer : public std::streambuf {
+    public:
+      static const size_t ChunkSize = 16384;
+
+      OutputBuffer(Request *);
+
+      size_t pending() const;
+
+    protected:
+      virtual int_type overflow(int_type);
+      virtual std::streamsize xsputn(const char *, std::streamsize);
+      virtual int sync();
+
+    private:
+      OutputBuffer(const OutputBuffer &);
+      OutputBuffer &operator=(const OutputBuffer &);
+
+      void flushBuffer();
+
+      Request *request;
+      char buffer[ChunkSize];
+    };
+
     Request();
     Request(const Request &);
 
@@ -55,6 +90,7 @@ namespace CForum {
 
     virtual const URI &getUri() const;
     virtual const CGI &getCGI() const = 0;
+    const std::string &getRequestMethod() const;
 
     virtual boost::shared_ptr<Template> getTemplate();
 
@@ -66,19 +102,81 @@ namespace CForum {
 
     virtual void output(const std::string &) = 0;
 
-    virtual void initTemplate(boost::shared_ptr<Configparser>);
+    virtual std::ostream &getOutputStream();
+    virtual void commit();
+    virtual void finish();
+    bool isCommitted() const;
+    bool hasOutput() const;
+
+    virtual void setImmutable(const std::string &);
+    virtual bool sendPrecompressed(const std::string &);
+
+    /**
+     * Sets ETag and Last-Modified and answers with 304 when the client's
+     * copy is still current; returns true if the response has been sent
+     */
+    virtual bool notModified(const std::string &, time_t) = 0;
+    const std::string &getETag() const;
+    time_t getLastModified() const;
+
+    /** Appends a copy of the uncompressed body to the given string */
+    void captureBody(boost::shared_ptr<std::string>);
+
+    virtual void initTemplate(boost::shared_ptr<Configparser>, boost::shared_ptr<TemplatePool> = boost::shared_ptr<TemplatePool>(), v8::Handle<v8::ObjectTemplate> = v8::Handle<v8::ObjectTemplate>(), ConfigValueCache * = NULL);
+
+    /** the template of the configparser global; callers keep one per isolate */
+    static v8::Local<v8::ObjectTemplate> createConfigparserTemplate();
 
     virtual ~Request() = 0;
 
   protected:
     URI requestUri;
+    std::string requestMethod;
     User user;
+
+    /* the template's configparser object points to it, so it has to outlive the template */
+    boost::shared_ptr<Configparser> configparser;
     boost::shared_ptr<Template> tpl;
 
     std::unordered_map<std::string, std::string> headers;
 
+    virtual void sendHeaders() = 0;
+    virtual void sendBody(const char *, size_t) = 0;
+    virtual void endBody();
+
+    virtual void selectEncoding();
+    void writeBody(const char *, size_t);
+    void compressBody(const char *, size_t, bool, std::string &);
+    const std::string *findHeader(const char *) const;
+    bool isBodyless() const;
+
+    bool committed, finished, encodingSelected;
+    long contentLength;
+    boost::shared_ptr<OutputBuffer> outputBuffer;
+    boost::shared_ptr<std::ostream> outputStream;
+
+    boost::shared_ptr<const ResponseCompressor::Settings> compression;
+    boost::shared_ptr<ResponseCompressor> compressor;
+    std::string immutableKey, compressedBody;
+
+    std::string etag;
+    time_t lastModified;
+    boost::shared_ptr<std::string> capture;
+
   };
 
+  inline size_t Request::OutputBuffer::pending() const {
+    return pptr() - pbase();
+  }
+
+  inline bool Request::isCommitted() const {
+    return committed;
+  }
+
+  inline bool Request::hasOutput() const {
+    return committed || (outputBuffer && outputBuffer->pending() > 0);
+  }
+
   inline std::unordered_map<std::string, std::string> const &Request::getHeaders() {
     return headers;
   }
@@ -87,6 +185,22 @@ namespace CForum {
     return requestUri;
   }
 
+  inline const std::string &Request::getRequestMethod() const {
+    return requestMethod;
+  }
+
+  inline const std::string &Request::getETag() const {
+    return etag;
+  }
+
+  inline time_t Request::getLastModified() const {
+    return lastModified;
+  }
+
+  inline void Request::captureBody(boost::shared_ptr<std::string> str) {
+    capture = str;
+  }
+
   inline void Request::setUser(const User &usr) {
     user = usr;
   }
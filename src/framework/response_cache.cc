@@ -0,0 +1,278 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response cache implementation; full page output cache
+ * \package framework
+ *
+ * The response cache keeps rendered pages for anonymous visitors in memory
+ * and replays them instead of running the controllers
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/response_cache.hh"
+
+namespace CForum {
+  ResponseCache::Entry::Entry() : headers(), body(), etag(), id(), modified(0), stored(0), generation(0) { }
+
+  ResponseCache::ResponseCache() : entries(), order(), size(0), limit(0), maxAge(0), serial(0), epoch(NULL), localEpoch(0), seenEpoch(0) {
+    void *mem = mmap(NULL, sizeof(*epoch), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    /* without the shared mapping every process invalidates on its own */
+    epoch = mem == MAP_FAILED ? &localEpoch : (volatile unsigned long *)mem;
+    *epoch = 0;
+
+    pthread_mutex_init(&lock, NULL);
+  }
+
+  std::string ResponseCache::normalizeQuery(const std::string &query) {
+    std::vector<std::string> params;
+    std::string retval;
+    size_t pos = 0, end;
+
+    while(pos <= query.length()) {
+      if((end = query.find('&', pos)) == std::string::npos) {
+        end = query.length();
+      }
+
+      if(end > pos) {
+        params.push_back(query.substr(pos, end - pos));
+      }
+
+      pos = end + 1;
+    }
+
+    std::sort(params.begin(), params.end());
+
+    for(std::vector<std::string>::const_iterator it = params.begin(); it != params.end(); ++it) {
+      if(!retval.empty()) {
+        retval += '&';
+      }
+
+      retval += *it;
+    }
+
+    return retval;
+  }
+
+  std::string ResponseCache::keyFor(boost::shared_ptr<Request> rq) {
+    const std::string &method = rq->getRequestMethod();
+    const URI &uri = rq->getUri();
+    std::string host = uri.getHost(), key;
+    char port[16];
+
+    if(limit == 0 || (method != "GET" && method != "HEAD")) {
+      return std::string();
+    }
+
+    /* only anonymous visitors share a page */
+    if(!rq->getUser().getUsername().empty()) {
+      return std::string();
+    }
+
+    for(std::string::iterator it = host.begin(); it != host.end(); ++it) {
+      *it = (char)tolower((unsigned char)*it);
+    }
+
+    snprintf(port, sizeof(port), ":%d", uri.getPort());
+
+    URIPart scheme = uri.getScheme(), path = uri.getPath(), media = uri.getMedia();
+
+    key.reserve(scheme.length() + host.length() + path.length() + uri.getQueryString().length() + media.length() + 32);
+    key.append(scheme.data(), scheme.length());
+    key += "://";
+    key += host;
+    key += port;
+    key.append(path.data(), path.length());
+    key += '?';
+    key += normalizeQuery(uri.getQueryString());
+    key += '\n';
+    key.append(media.data(), media.length());
+    key += "\nanonymous";
+
+    return key;
+  }
+
+  void ResponseCache::evict(std::unordered_map<std::string, Slot>::iterator it) {
+    size -= it->second.entry->body.length();
+    order.erase(it->second.position);
+    entries.erase(it);
+  }
+
+  /* called with the lock held */
+  void ResponseCache::syncEpoch() {
+    if(seenEpoch != *epoch) {
+      entries.clear();
+      order.clear();
+      size      = 0;
+      seenEpoch = *epoch;
+    }
+  }
+
+  boost::shared_ptr<const ResponseCache::Entry> ResponseCache::lookup(const std::string &key, unsigned long generation) {
+    boost::shared_ptr<const Entry> entry;
+    std::unordered_map<std::string, Slot>::iterator it;
+
+    pthread_mutex_lock(&lock);
+
+    syncEpoch();
+
+    if((it = entries.find(key)) != entries.end()) {
+      /* pages rendered with an older config are as good as gone */
+      if(it->second.entry->generation != generation || (maxAge > 0 && it->second.entry->stored + maxAge <= time(NULL))) {
+        evict(it);
+      }
+      else {
+        order.splice(order.end(), order, it->second.position);
+        entry = it->second.entry;
+      }
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    return entry;
+  }
+
+  void ResponseCache::replay(boost::shared_ptr<const Entry> entry, boost::shared_ptr<Request> rq) {
+    std::vector<std::pair<std::string, std::string> >::const_iterator it, end;
+
+    for(it = entry->headers.begin(), end = entry->headers.end(); it != end; ++it) {
+      rq->setHeader(it->first, it->second);
+    }
+
+    if((!entry->etag.empty() || entry->modified > 0) && rq->notModified(entry->etag, entry->modified)) {
+      return;
+    }
+
+    /* the compressed variants live as long as the entry's id is in use */
+    rq->setImmutable(entry->id);
+
+    if(rq->sendPrecompressed(entry->id)) {
+      rq->finish();
+    }
+    else {
+      rq->output(entry->body);
+    }
+  }
+
+  void ResponseCache::store(const std::string &key, boost::shared_ptr<Request> rq, const std::string &body, unsigned long generation, unsigned long rendered_epoch) {
+    std::unordered_map<std::string, std::string> const &headers = rq->getHeaders();
+    std::unordered_map<std::string, std::string>::const_iterator it, end = headers.end();
+    boost::shared_ptr<Entry> entry;
+    char id[32];
+
+    if(body.length() > limit) {
+      return;
+    }
+
+    entry = boost::make_shared<Entry>();
+
+    for(it = headers.begin(); it != end; ++it) {
+      const char *nam = it->first.c_str();
+
+      /* errors, redirects and anything setting a cookie are private to this request */
+      if(strcasecmp(nam, "status") == 0 && it->second.compare(0, 3, "200") != 0) {
+        return;
+      }
+      if(strcasecmp(nam, "set-cookie") == 0) {
+        return;
+      }
+
+      /* negotiated per request, the validators are set by notModified() */
+      if(strcasecmp(nam, "status") == 0 || strcasecmp(nam, "content-encoding") == 0 || strcasecmp(nam, "vary") == 0 || strcasecmp(nam, "content-length") == 0 || strcasecmp(nam, "etag") == 0 || strcasecmp(nam, "last-modified") == 0) {
+        continue;
+      }
+
+      entry->headers.push_back(*it);
+    }
+
+    entry->body       = body;
+    entry->etag       = rq->getETag();
+    entry->modified   = rq->getLastModified();
+    entry->stored     = time(NULL);
+    entry->generation = generation;
+
+    pthread_mutex_lock(&lock);
+
+    /* a page rendered while an invalidation came in may already be stale */
+    if(rendered_epoch == *epoch) {
+      syncEpoch();
+
+      std::unordered_map<std::string, Slot>::iterator old = entries.find(key);
+      if(old != entries.end()) {
+        evict(old);
+      }
+
+      snprintf(id, sizeof(id), "page:%d:%lu", (int)getpid(), ++serial);
+      entry->id = id;
+
+      Slot &slot = entries[key];
+      slot.entry    = entry;
+      slot.position = order.insert(order.end(), key);
+      size         += body.length();
+
+      while(size > limit && !order.empty()) {
+        evict(entries.find(order.front()));
+      }
+    }
+
+    pthread_mutex_unlock(&lock);
+  }
+
+  void ResponseCache::invalidate() {
+    __sync_add_and_fetch(epoch, 1);
+  }
+
+  void ResponseCache::setLimit(size_t lim) {
+    pthread_mutex_lock(&lock);
+
+    limit = lim;
+
+    while(size > limit && !order.empty()) {
+      evict(entries.find(order.front()));
+    }
+
+    pthread_mutex_unlock(&lock);
+  }
+
+  void ResponseCache::setMaxAge(time_t age) {
+    pthread_mutex_lock(&lock);
+    maxAge = age;
+    pthread_mutex_unlock(&lock);
+  }
+
+  void ResponseCache::receiveNotification(boost::shared_ptr<Request>, void *) {
+    /* every thread shows up in the thread list, so a change touches all pages */
+    invalidate();
+  }
+
+  ResponseCache::~ResponseCache() {
+    if(epoch != &localEpoch) {
+      munmap((void *)epoch, sizeof(*epoch));
+    }
+
+    pthread_mutex_destroy(&lock);
+  }
+
+}
+
+/* eof */
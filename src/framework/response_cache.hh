@@ -0,0 +1,133 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response cache interface; full page output cache
+ * \package framework
+ *
+ * The response cache keeps rendered pages for anonymous visitors in memory
+ * and replays them instead of running the controllers
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <utility>
+#include <algorithm>
+
+#include <cctype>
+#include <ctime>
+#include <cstdio>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "hash_map.hh"
+
+#include "framework/request.hh"
+#include "framework/notification_center.hh"
+
+namespace CForum {
+  class ResponseCache : public NotificationCenter::NotificationReceiver {
+  public:
+    class Entry {
+    public:
+      Entry();
+
+      std::vector<std::pair<std::string, std::string> > headers;
+      std::string body, etag, id;
+      time_t modified, stored;
+      unsigned long generation;
+    };
+
+    ResponseCache();
+    virtual ~ResponseCache();
+
+    std::string keyFor(boost::shared_ptr<Request>);
+
+    boost::shared_ptr<const Entry> lookup(const std::string &, unsigned long);
+    void replay(boost::shared_ptr<const Entry>, boost::shared_ptr<Request>);
+    void store(const std::string &, boost::shared_ptr<Request>, const std::string &, unsigned long, unsigned long);
+
+    void invalidate();
+    unsigned long getEpoch() const;
+
+    void setLimit(size_t);
+    size_t getLimit() const;
+    void setMaxAge(time_t);
+
+    virtual void receiveNotification(boost::shared_ptr<Request>, void *);
+
+  private:
+    ResponseCache(const ResponseCache &);
+    ResponseCache &operator=(const ResponseCache &);
+
+    typedef std::list<std::string> KeyList;
+
+    class Slot {
+    public:
+      boost::shared_ptr<const Entry> entry;
+      KeyList::iterator position;
+    };
+
+    void syncEpoch();
+    void evict(std::unordered_map<std::string, Slot>::iterator);
+
+    static std::string normalizeQuery(const std::string &);
+
+    std::unordered_map<std::string, Slot> entries;
+    KeyList order;
+    size_t size, limit;
+    time_t maxAge;
+    unsigned long serial;
+
+    /*
+     * invalidations are counted in a shared mapping, so a prefork worker
+     * notices when any of its siblings threw the pages away
+     */
+    volatile unsigned long *epoch;
+    unsigned long localEpoch, seenEpoch;
+
+    pthread_mutex_t lock;
+  };
+
+  inline size_t ResponseCache::getLimit() const {
+    return limit;
+  }
+
+  inline unsigned long ResponseCache::getEpoch() const {
+    return *epoch;
+  }
+
+}
+
+#endif
+
+/* eof */
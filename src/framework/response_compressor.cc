@@ -0,0 +1,233 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response compressor implementation; gzip/deflate content encoding
+ * \package framework
+ *
+ * The response compressor deflates response bodies for clients accepting a
+ * content encoding and keeps precompressed bodies of immutable responses
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/response_compressor.hh"
+
+namespace CForum {
+  ResponseCompressor::Settings::Settings() : level(Z_DEFAULT_COMPRESSION), minLength(256) { }
+
+  boost::shared_ptr<const ResponseCompressor::Settings> ResponseCompressor::settings = boost::make_shared<ResponseCompressor::Settings>();
+  pthread_mutex_t ResponseCompressor::settingsLock = PTHREAD_MUTEX_INITIALIZER;
+
+  std::unordered_map<std::string, ResponseCompressor::Entry> ResponseCompressor::precompressed;
+  ResponseCompressor::KeyList ResponseCompressor::precompressedOrder;
+  size_t ResponseCompressor::precompressedSize = 0;
+  size_t ResponseCompressor::precompressedLimit = 8 * 1024 * 1024;
+  pthread_mutex_t ResponseCompressor::precompressedLock = PTHREAD_MUTEX_INITIALIZER;
+
+  ResponseCompressor::ResponseCompressor(Encoding enc, int lvl) : encoding(enc), finished(false) {
+    memset(&stream, 0, sizeof(stream));
+
+    /* 16 added to the window bits selects the gzip wrapper, deflate is the zlib format (RFC 2616, 3.5) */
+    if(deflateInit2(&stream, lvl, Z_DEFLATED, enc == EncodingGzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      finished = true;
+    }
+  }
+
+  void ResponseCompressor::compress(const char *buff, size_t len, bool finish, std::string &out) {
+    char chunk[16384];
+    int rc;
+
+    if(finished) {
+      return;
+    }
+
+    stream.next_in  = reinterpret_cast<Bytef *>(const_cast<char *>(buff));
+    stream.avail_in = (uInt)len;
+
+    /* a sync flush per chunk lets the client render while we are still busy */
+    do {
+      stream.next_out  = reinterpret_cast<Bytef *>(chunk);
+      stream.avail_out = sizeof(chunk);
+
+      rc = deflate(&stream, finish ? Z_FINISH : Z_SYNC_FLUSH);
+      out.append(chunk, sizeof(chunk) - stream.avail_out);
+    } while(rc == Z_OK && stream.avail_out == 0);
+
+    if(finish) {
+      finished = true;
+    }
+  }
+
+  ResponseCompressor::Encoding ResponseCompressor::negotiate(const std::string &accept) {
+    bool gzip = false, deflate = false, any = false, noGzip = false, noDeflate = false, refused;
+    size_t pos = 0, end, semi, param, q;
+    std::string token;
+
+    while(pos < accept.length()) {
+      if((end = accept.find(',', pos)) == std::string::npos) {
+        end = accept.length();
+      }
+
+      token = accept.substr(pos, end - pos);
+      pos = end + 1;
+      refused = false;
+
+      /* gzip;q=0 means „anything but gzip“; parameter names are case-insensitive */
+      if((semi = token.find(';')) != std::string::npos) {
+        for(param = semi; param != std::string::npos; param = token.find(';', param + 1)) {
+          q = token.find_first_not_of(" \t", param + 1);
+
+          if(q != std::string::npos && tolower(token[q]) == 'q' && (q = token.find_first_not_of(" \t", q + 1)) != std::string::npos && token[q] == '=') {
+            refused = strtod(token.c_str() + q + 1, NULL) <= 0.0;
+          }
+        }
+
+        token.erase(semi);
+      }
+
+      token.erase(0, token.find_first_not_of(" \t"));
+      token.erase(token.find_last_not_of(" \t") + 1);
+
+      if(strcasecmp(token.c_str(), "gzip") == 0 || strcasecmp(token.c_str(), "x-gzip") == 0) {
+        (refused ? noGzip : gzip) = true;
+      }
+      else if(strcasecmp(token.c_str(), "deflate") == 0) {
+        (refused ? noDeflate : deflate) = true;
+      }
+      else if(token == "*" && !refused) {
+        any = true;
+      }
+    }
+
+    /* * only stands for the codings the client didn't refuse by name */
+    if(gzip || (any && !noGzip)) {
+      return EncodingGzip;
+    }
+
+    if(deflate || (any && !noDeflate)) {
+      return EncodingDeflate;
+    }
+
+    return EncodingIdentity;
+  }
+
+  const char *ResponseCompressor::encodingName(Encoding enc) {
+    switch(enc) {
+      case EncodingGzip:    return "gzip";
+      case EncodingDeflate: return "deflate";
+      default:              return "identity";
+    }
+  }
+
+  bool ResponseCompressor::isCompressible(const std::string &type) {
+    return strncasecmp(type.c_str(), "text/", 5) == 0 ||
+      strncasecmp(type.c_str(), "application/json", 16) == 0 ||
+      strncasecmp(type.c_str(), "application/javascript", 22) == 0 ||
+      strncasecmp(type.c_str(), "application/xml", 15) == 0 ||
+      strncasecmp(type.c_str(), "application/xhtml+xml", 21) == 0 ||
+      strncasecmp(type.c_str(), "application/rss+xml", 19) == 0 ||
+      strncasecmp(type.c_str(), "application/atom+xml", 20) == 0;
+  }
+
+  boost::shared_ptr<const std::string> ResponseCompressor::getPrecompressed(const std::string &key, Encoding enc) {
+    boost::shared_ptr<const std::string> data;
+    std::string name = std::string(encodingName(enc)) + ":" + key;
+
+    pthread_mutex_lock(&precompressedLock);
+
+    std::unordered_map<std::string, Entry>::iterator it = precompressed.find(name);
+    if(it != precompressed.end()) {
+      precompressedOrder.splice(precompressedOrder.end(), precompressedOrder, it->second.position);
+      data = it->second.data;
+    }
+
+    pthread_mutex_unlock(&precompressedLock);
+
+    return data;
+  }
+
+  void ResponseCompressor::storePrecompressed(const std::string &key, Encoding enc, const std::string &body) {
+    std::string name = std::string(encodingName(enc)) + ":" + key;
+
+    if(body.length() > precompressedLimit) {
+      return;
+    }
+
+    pthread_mutex_lock(&precompressedLock);
+
+    if(precompressed.find(name) == precompressed.end()) {
+      Entry &entry = precompressed[name];
+
+      entry.data     = boost::make_shared<const std::string>(body);
+      entry.position = precompressedOrder.insert(precompressedOrder.end(), name);
+      precompressedSize += body.length();
+
+      /* least recently used ones go first */
+      while(precompressedSize > precompressedLimit && !precompressedOrder.empty()) {
+        std::unordered_map<std::string, Entry>::iterator old = precompressed.find(precompressedOrder.front());
+
+        precompressedSize -= old->second.data->length();
+        precompressed.erase(old);
+        precompressedOrder.pop_front();
+      }
+    }
+
+    pthread_mutex_unlock(&precompressedLock);
+  }
+
+  void ResponseCompressor::setSettings(boost::shared_ptr<const Settings> set) {
+    pthread_mutex_lock(&settingsLock);
+    settings = set;
+    pthread_mutex_unlock(&settingsLock);
+  }
+
+  boost::shared_ptr<const ResponseCompressor::Settings> ResponseCompressor::getSettings() {
+    boost::shared_ptr<const Settings> set;
+
+    pthread_mutex_lock(&settingsLock);
+    set = settings;
+    pthread_mutex_unlock(&settingsLock);
+
+    return set;
+  }
+
+  void ResponseCompressor::setPrecompressedLimit(size_t limit) {
+    pthread_mutex_lock(&precompressedLock);
+    precompressedLimit = limit;
+    pthread_mutex_unlock(&precompressedLock);
+  }
+
+  void ResponseCompressor::clearPrecompressed() {
+    pthread_mutex_lock(&precompressedLock);
+    precompressed.clear();
+    precompressedOrder.clear();
+    precompressedSize = 0;
+    pthread_mutex_unlock(&precompressedLock);
+  }
+
+  ResponseCompressor::~ResponseCompressor() {
+    deflateEnd(&stream);
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,130 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response compressor interface; gzip/deflate content encoding
+ * \package framework
+ *
+ * The response compressor deflates response bodies for clients accepting a
+ * content encoding and keeps precompressed bodies of immutable responses
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef RESPONSE_COMPRESSOR_H
+#define RESPONSE_COMPRESSOR_H
+
+#include <string>
+#include <list>
+#include <utility>
+
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <strings.h>
+#include <pthread.h>
+
+#include <zlib.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "hash_map.hh"
+
+namespace CForum {
+  class ResponseCompressor {
+  public:
+    enum Encoding {
+      EncodingIdentity,
+      EncodingGzip,
+      EncodingDeflate
+    };
+
+    ResponseCompressor(Encoding, int);
+    ~ResponseCompressor();
+
+    void compress(const char *, size_t, bool, std::string &);
+
+    Encoding getEncoding() const;
+    bool isFinished() const;
+
+    static Encoding negotiate(const std::string &);
+    static const char *encodingName(Encoding);
+    static bool isCompressible(const std::string &);
+
+    /**
+     * Replaced as a whole when the config is reloaded; a request keeps the
+     * settings it started with
+     */
+    class Settings {
+    public:
+      Settings();
+
+      int level; /**< 0 switches compression off, -1 is zlib's default */
+      size_t minLength;
+    };
+
+    static void setSettings(boost::shared_ptr<const Settings>);
+    static boost::shared_ptr<const Settings> getSettings();
+
+    static boost::shared_ptr<const std::string> getPrecompressed(const std::string &, Encoding);
+    static void storePrecompressed(const std::string &, Encoding, const std::string &);
+    static void setPrecompressedLimit(size_t);
+    static void clearPrecompressed();
+
+  private:
+    ResponseCompressor(const ResponseCompressor &);
+    ResponseCompressor &operator=(const ResponseCompressor &);
+
+    typedef std::list<std::string> KeyList;
+
+    class Entry {
+    public:
+      boost::shared_ptr<const std::string> data;
+      KeyList::iterator position;
+    };
+
+    z_stream stream;
+    Encoding encoding;
+    bool finished;
+
+    static boost::shared_ptr<const Settings> settings;
+    static pthread_mutex_t settingsLock;
+
+    static std::unordered_map<std::string, Entry> precompressed;
+    static KeyList precompressedOrder;
+    static size_t precompressedSize, precompressedLimit;
+    static pthread_mutex_t precompressedLock;
+  };
+
+  inline ResponseCompressor::Encoding ResponseCompressor::getEncoding() const {
+    return encoding;
+  }
+
+  inline bool ResponseCompressor::isFinished() const {
+    return finished;
+  }
+
+}
+
+#endif
+
+/* eof */
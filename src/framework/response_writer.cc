@@ -0,0 +1,118 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response writer implementation; gathers a response for writev()
+ * \package framework
+ *
+ * The response writer collects the status line, headers and body segments of a
+ * response as an iovec list and writes them with as few system calls as possible
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/response_writer.hh"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace CForum {
+  ResponseWriter::ResponseWriter() : segments(), copies(), first(0), remaining(0) { }
+
+  void ResponseWriter::addCopy(const char *buff, size_t len) {
+    if(len == 0) {
+      return;
+    }
+
+    /* a deque doesn't move its elements, so the pointer stays valid */
+    copies.push_back(std::string(buff, len));
+    add(copies.back().data(), len);
+  }
+
+  void ResponseWriter::consume(size_t len) {
+    while(len > 0 && first < segments.size()) {
+      struct iovec &iov = segments[first];
+
+      if(len >= iov.iov_len) {
+        len -= iov.iov_len;
+        remaining -= iov.iov_len;
+        ++first;
+      }
+      else {
+        iov.iov_base = reinterpret_cast<char *>(iov.iov_base) + len;
+        iov.iov_len -= len;
+        remaining -= len;
+        len = 0;
+      }
+    }
+  }
+
+  ssize_t ResponseWriter::writeTo(int fd) {
+    size_t written = 0, cnt;
+    ssize_t len;
+
+    while(first < segments.size()) {
+      cnt = segments.size() - first;
+
+      if(cnt > IOV_MAX) {
+        cnt = IOV_MAX;
+      }
+
+      if((len = writev(fd, &segments[first], (int)cnt)) < 0) {
+        if(errno == EINTR) {
+          continue;
+        }
+
+        /* a non-blocking socket is full; the caller keeps the rest */
+        if(errno == EAGAIN || errno == EWOULDBLOCK) {
+          break;
+        }
+
+        return -1;
+      }
+
+      written += (size_t)len;
+      consume((size_t)len);
+    }
+
+    return (ssize_t)written;
+  }
+
+  void ResponseWriter::appendTo(std::string &out) const {
+    out.reserve(out.length() + remaining);
+
+    for(size_t i = first; i < segments.size(); ++i) {
+      out.append(reinterpret_cast<const char *>(segments[i].iov_base), segments[i].iov_len);
+    }
+  }
+
+  void ResponseWriter::clear() {
+    segments.clear();
+    copies.clear();
+
+    first     = 0;
+    remaining = 0;
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,126 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response writer interface; gathers a response for writev()
+ * \package framework
+ *
+ * The response writer collects the status line, headers and body segments of a
+ * response as an iovec list and writes them with as few system calls as possible
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef RESPONSE_WRITER_H
+#define RESPONSE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace CForum {
+  class ResponseWriter {
+  public:
+    ResponseWriter();
+
+    void add(const char *, size_t);
+    void add(const char *);
+    void add(const std::string &);
+    void addCopy(const char *, size_t);
+    void addCopy(const std::string &);
+
+    ssize_t writeTo(int);
+    void appendTo(std::string &) const;
+
+    const struct iovec *getSegments() const;
+    size_t getSegmentCount() const;
+    size_t length() const;
+    bool empty() const;
+
+    void clear();
+
+  private:
+    ResponseWriter(const ResponseWriter &);
+    ResponseWriter &operator=(const ResponseWriter &);
+
+    void consume(size_t);
+
+    std::vector<struct iovec> segments;
+    std::deque<std::string> copies;
+    size_t first, remaining;
+  };
+
+  /* referenced segments must stay valid until the writer has been written or cleared */
+  inline void ResponseWriter::add(const char *buff, size_t len) {
+    struct iovec iov;
+
+    if(len == 0) {
+      return;
+    }
+
+    iov.iov_base = const_cast<char *>(buff);
+    iov.iov_len  = len;
+
+    segments.push_back(iov);
+    remaining += len;
+  }
+
+  inline void ResponseWriter::add(const char *str) {
+    add(str, strlen(str));
+  }
+
+  inline void ResponseWriter::add(const std::string &str) {
+    add(str.data(), str.length());
+  }
+
+  inline void ResponseWriter::addCopy(const std::string &str) {
+    addCopy(str.data(), str.length());
+  }
+
+  inline const struct iovec *ResponseWriter::getSegments() const {
+    return segments.empty() ? NULL : &segments[first];
+  }
+
+  inline size_t ResponseWriter::getSegmentCount() const {
+    return segments.size() - first;
+  }
+
+  inline size_t ResponseWriter::length() const {
+    return remaining;
+  }
+
+  inline bool ResponseWriter::empty() const {
+    return remaining == 0;
+  }
+
+}
+
+#endif
+
+/* eof */
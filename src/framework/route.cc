@@ -33,15 +33,19 @@
 #include "framework/route.hh"
 
 namespace CForum {
-  Route::Pattern::Pattern() : names(), pattern(), regex() { }
-  Route::Pattern::Pattern(const std::string &pat, const std::vector<std::string> &nams) : names(nams), pattern(pat), regex(boost::make_shared<pcrepp::Pcre>(pat)) { }
-  Route::Pattern::Pattern(const Route::Pattern &pat) : names(pat.names), pattern(pat.pattern), regex(boost::make_shared<pcrepp::Pcre>(*pat.regex)) { }
+  Route::Pattern::Pattern() : names(), types(), pattern(), regex() { }
+  Route::Pattern::Pattern(const std::string &pat, const std::vector<std::string> &nams) : names(nams), types(), pattern(pat), regex(boost::make_shared<CompiledPattern>(pat)) { }
+  Route::Pattern::Pattern(const std::string &pat, const std::vector<std::string> &nams, const std::vector<enum CaptureType> &typs) : names(nams), types(typs), pattern(pat), regex(boost::make_shared<CompiledPattern>(pat)) { }
+
+  /* compiled patterns are immutable, copies just share them */
+  Route::Pattern::Pattern(const Route::Pattern &pat) : names(pat.names), types(pat.types), pattern(pat.pattern), regex(pat.regex) { }
 
   Route::Pattern &Route::Pattern::operator=(const Route::Pattern &pat) {
     if(this != &pat) {
       pattern = pat.pattern;
       names   = pat.names;
-      *regex  = *pat.regex;
+      types   = pat.types;
+      regex   = pat.regex;
     }
 
     return *this;
@@ -74,6 +78,8 @@ namespace CForum {
     const char *ptr = pattern.c_str(), *start;
     std::ostringstream ostr;
     std::vector<std::string> names;
+    std::vector<enum CaptureType> types;
+    std::string expr;
 
     for(; *ptr; ++ptr) {
       switch(*ptr) {
@@ -87,19 +93,19 @@ namespace CForum {
             if(*ptr == ':') {
               names.push_back(std::string(start, ptr - start));
               start = ++ptr;
-              ostr << '(';
+              expr.clear();
 
               for(; *ptr && *ptr != '>'; ++ptr) {
                 switch(*ptr) {
                   case '\\':
                     if(*(ptr + 1) == '>') {
-                      ostr << '>';
+                      expr += '>';
                       ++ptr;
                       break;
                     }
 
                   default:
-                    ostr << *ptr;
+                    expr += *ptr;
                 }
               }
 
@@ -107,7 +113,20 @@ namespace CForum {
                 throw RouteSyntaxException("Error: named <pattern> is not closed!", RouteSyntaxException::NamedPatternNotClosedError);
               }
 
-              ostr << ')';
+              /* at most 18 digits, so every id fits into a long long */
+              if(expr == "int") {
+                types.push_back(CaptureTypeInt);
+                expr = "[0-9]{1,18}";
+              }
+              else if(expr == "slug") {
+                types.push_back(CaptureTypeSlug);
+                expr = "[A-Za-z0-9]+(?:-[A-Za-z0-9]+)*";
+              }
+              else {
+                types.push_back(CaptureTypeText);
+              }
+
+              ostr << '(' << expr << ')';
 
               break;
             }
@@ -128,7 +147,13 @@ namespace CForum {
 
     }
 
-    patterns.push_back(Route::Pattern(ostr.str(), names));
+    Route::Pattern compiled(ostr.str(), names, types);
+
+    if(compiled.getCompiledPattern()->getCaptureCount() > MaxCaptures) {
+      throw RouteSyntaxException("Error: too many capturing groups in pattern!", RouteSyntaxException::TooManyCapturesError);
+    }
+
+    patterns.push_back(compiled);
   }
 
   Route::~Route() { }
@@ -34,20 +34,31 @@
 #define ROUTE_H
 
 #include <sstream>
-#include <pcre++.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 
 #include "framework/controller.hh"
 #include "framework/route_syntax_exception.hh"
+#include "framework/compiled_pattern.hh"
 
 namespace CForum {
   class Route {
   public:
+    /** <name:int> and <name:slug> captures get checked while matching */
+    enum CaptureType {
+      CaptureTypeText,
+      CaptureTypeInt,
+      CaptureTypeSlug
+    };
+
+    /** a pattern may not have more capturing groups than this */
+    static const int MaxCaptures = 31;
+
     class Pattern {
     public:
       Pattern();
       Pattern(const std::string &, const std::vector<std::string> &);
+      Pattern(const std::string &, const std::vector<std::string> &, const std::vector<enum CaptureType> &);
       Pattern(const Pattern &);
 
       Pattern &operator=(const Pattern &);
@@ -55,15 +66,19 @@ namespace CForum {
       const std::string &getPattern() const;
       void setPattern(const std::string &);
 
-      const boost::shared_ptr<pcrepp::Pcre> getCompiledPattern() const;
+      boost::shared_ptr<const CompiledPattern> getCompiledPattern() const;
 
       const std::vector<std::string> &getNames() const;
       void setNames(const std::vector<std::string> &);
 
+      enum CaptureType getType(size_t) const;
+      size_t indexOf(const std::string &) const;
+
     protected:
       std::vector<std::string> names;
+      std::vector<enum CaptureType> types;
       std::string pattern;
-      boost::shared_ptr<pcrepp::Pcre> regex;
+      boost::shared_ptr<const CompiledPattern> regex;
     };
 
     class ACL {
@@ -126,10 +141,10 @@ namespace CForum {
 
   inline void Route::Pattern::setPattern(const std::string &patt) {
     pattern = patt;
-    regex   = boost::make_shared<pcrepp::Pcre>(patt);
+    regex   = boost::make_shared<CompiledPattern>(patt);
   }
 
-  inline const boost::shared_ptr<pcrepp::Pcre> Route::Pattern::getCompiledPattern() const {
+  inline boost::shared_ptr<const CompiledPattern> Route::Pattern::getCompiledPattern() const {
     return regex;
   }
 
@@ -141,6 +156,23 @@ namespace CForum {
     names = nams;
   }
 
+  inline enum Route::CaptureType Route::Pattern::getType(size_t i) const {
+    return i < types.size() ? types[i] : CaptureTypeText;
+  }
+
+  /** the index a capture will have in the RouteVars of a match */
+  inline size_t Route::Pattern::indexOf(const std::string &name) const {
+    size_t i;
+
+    for(i = 0; i < names.size(); ++i) {
+      if(names[i] == name) {
+        return i;
+      }
+    }
+
+    return (size_t)-1;
+  }
+
   inline void Route::setAcl(boost::shared_ptr<Route::ACL> acl) {
     this->acl = acl;
   }
@@ -43,6 +43,8 @@ namespace CForum {
 
       static const int NamedPatternNotClosedError = 0x4ef4d6ed;
       static const int NamedPatternIdInvalidError = 0x4ef4d838;
+      static const int PatternCompileError        = 0x4fea17c5;
+      static const int TooManyCapturesError       = 0x4feb2f3a;
 
   };
 
@@ -0,0 +1,146 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Route variables implementation
+ * \package framework
+ *
+ * The variables a route pattern captured, as slices of the request path
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/route_vars.hh"
+
+namespace CForum {
+  RouteVars::RouteVars() : subject(NULL), pattern(NULL), count(0), map(NULL) { }
+
+  RouteVars::RouteVars(const RouteVars &vars) : subject(vars.subject), pattern(vars.pattern), count(vars.count), map(NULL) {
+    std::copy(vars.offsets, vars.offsets + count, offsets);
+    std::copy(vars.lengths, vars.lengths + count, lengths);
+    std::copy(vars.numbers, vars.numbers + count, numbers);
+  }
+
+  RouteVars &RouteVars::operator=(const RouteVars &vars) {
+    if(this != &vars) {
+      subject = vars.subject;
+      pattern = vars.pattern;
+      count   = vars.count;
+
+      delete map;
+      map = NULL;
+
+      std::copy(vars.offsets, vars.offsets + count, offsets);
+      std::copy(vars.lengths, vars.lengths + count, lengths);
+      std::copy(vars.numbers, vars.numbers + count, numbers);
+    }
+
+    return *this;
+  }
+
+  /*
+   * Takes the captures out of a PCRE ovector; group 0 is the whole
+   * match, the named groups follow. Returns false if a typed capture
+   * doesn't hold what its type promises
+   */
+  bool RouteVars::bind(const std::string *subj, const Route::Pattern &pat, const int *ovector, int rc) {
+    const std::vector<std::string> &names = pat.getNames();
+    size_t i, j;
+
+    subject = subj;
+    pattern = &pat;
+    count   = std::min(names.size(), (size_t)Route::MaxCaptures);
+
+    delete map;
+    map = NULL;
+
+    for(i = 0; i < count; ++i) {
+      if((int)i + 1 < rc && ovector[2 * i + 2] >= 0) {
+        offsets[i] = ovector[2 * i + 2];
+        lengths[i] = ovector[2 * i + 3] - ovector[2 * i + 2];
+      }
+      else {
+        offsets[i] = 0;
+        lengths[i] = 0;
+      }
+
+      numbers[i] = 0;
+
+      switch(pat.getType(i)) {
+        case Route::CaptureTypeInt:
+          if(lengths[i] == 0) {
+            return false;
+          }
+
+          for(j = 0; j < lengths[i]; ++j) {
+            numbers[i] = numbers[i] * 10 + ((*subject)[offsets[i] + j] - '0');
+          }
+          break;
+
+        case Route::CaptureTypeSlug:
+          if(lengths[i] == 0) {
+            return false;
+          }
+          break;
+
+        case Route::CaptureTypeText:
+          break;
+      }
+    }
+
+    return true;
+  }
+
+  size_t RouteVars::indexOf(const std::string &name) const {
+    size_t i = pattern ? pattern->indexOf(name) : NoVariable;
+    return i < count ? i : NoVariable;
+  }
+
+  const std::map<std::string, std::string> &RouteVars::getMap() const {
+    std::map<std::string, std::string> *built = map;
+    size_t i;
+
+    if(built != NULL) {
+      return *built;
+    }
+
+    built = new std::map<std::string, std::string>();
+
+    for(i = 0; i < count; ++i) {
+      (*built)[pattern->getNames()[i]] = subject->substr(offsets[i], lengths[i]);
+    }
+
+    /* someone else may have been faster; theirs is the one everybody uses */
+    if(!__sync_bool_compare_and_swap(&map, (std::map<std::string, std::string> *)NULL, built)) {
+      delete built;
+      built = map;
+    }
+
+    return *built;
+  }
+
+  RouteVars::~RouteVars() {
+    delete map;
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,116 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Route variables interface
+ * \package framework
+ *
+ * The variables a route pattern captured, as slices of the request path
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ROUTE_VARS_H
+#define ROUTE_VARS_H
+
+#include <string>
+#include <map>
+#include <algorithm>
+
+#include "framework/route.hh"
+
+namespace CForum {
+  /**
+   * Captures are kept as offsets into the matched path; controllers
+   * should look up the index of a name once, when they register their
+   * route, and access the variables by index afterwards. The pattern is
+   * referenced, not copied: the route it belongs to has to outlive us
+   */
+  class RouteVars {
+  public:
+    RouteVars();
+    RouteVars(const RouteVars &);
+    ~RouteVars();
+
+    RouteVars &operator=(const RouteVars &);
+
+    bool bind(const std::string *, const Route::Pattern &, const int *, int);
+
+    size_t size() const;
+    size_t indexOf(const std::string &) const;
+
+    const char *data(size_t) const;
+    size_t length(size_t) const;
+
+    std::string get(size_t) const;
+    std::string get(const std::string &) const;
+    long long getInt(size_t) const;
+
+    const std::map<std::string, std::string> &getMap() const;
+
+    static const size_t NoVariable = (size_t)-1;
+
+  protected:
+    const std::string *subject;
+    const Route::Pattern *pattern;
+    size_t count;
+
+    size_t offsets[Route::MaxCaptures], lengths[Route::MaxCaptures];
+    long long numbers[Route::MaxCaptures];
+
+    /*
+     * for controllers and ACLs still working with names; built on first
+     * use, a cached match may be asked from several threads at once
+     */
+    mutable std::map<std::string, std::string> * volatile map;
+  };
+
+  inline size_t RouteVars::size() const {
+    return count;
+  }
+
+  inline const char *RouteVars::data(size_t i) const {
+    return subject->data() + offsets[i];
+  }
+
+  inline size_t RouteVars::length(size_t i) const {
+    return lengths[i];
+  }
+
+  inline std::string RouteVars::get(size_t i) const {
+    return i < count ? subject->substr(offsets[i], lengths[i]) : std::string();
+  }
+
+  inline std::string RouteVars::get(const std::string &name) const {
+    return get(indexOf(name));
+  }
+
+  /** only <name:int> captures have a number, everything else is 0 */
+  inline long long RouteVars::getInt(size_t i) const {
+    return i < count ? numbers[i] : 0;
+  }
+
+
+}
+
+#endif
+
+/* eof */
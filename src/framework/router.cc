@@ -31,81 +31,291 @@
  */
 
 #include "framework/router.hh"
+#include "framework/route_vars.hh"
 
 namespace CForum {
-  Router::Router() : routes() {}
+  class Router::Resolution {
+  public:
+    class Match {
+    public:
+      Match(boost::shared_ptr<Route>);
 
-  Router::Router(const Router &router) : routes(router.routes) { }
+      boost::shared_ptr<Route> route;
+      RouteVars vars;
+      bool aclFree;
+    };
+
+    std::string path; /**< the vars are slices of this */
+    std::vector<Match> matches;
+  };
+
+  Router::MatchEntry::MatchEntry(boost::shared_ptr<Route> rt, size_t pat) : route(rt), pattern(pat) { }
+
+  Router::PrefixNode::PrefixNode() : children(), entries() { }
+
+  Router::Resolution::Match::Match(boost::shared_ptr<Route> rt) : route(rt), vars(), aclFree(!rt->getAcl()) { }
+
+  Router::Router() : routes(), order(), urls(), baseURL(), entries(), trie(1), cache(), cacheOrder(), cacheLimit(512), lookupKey() {
+    pthread_mutex_init(&cacheLock, NULL);
+  }
+
+  Router::Router(const Router &router) : routes(router.routes), order(router.order), urls(router.urls), baseURL(router.baseURL), entries(router.entries), trie(router.trie), cache(), cacheOrder(), cacheLimit(router.cacheLimit), lookupKey() {
+    pthread_mutex_init(&cacheLock, NULL);
+  }
 
   Router &Router::operator=(const Router &r) {
     if(this != &r) {
-      routes = r.routes;
+      routes     = r.routes;
+      order      = r.order;
+      urls       = r.urls;
+      baseURL    = r.baseURL;
+      entries    = r.entries;
+      trie       = r.trie;
+      cacheLimit = r.cacheLimit;
+
+      flush();
     }
 
     return *this;
   }
 
-  std::string Router::dispatch(boost::shared_ptr<Request> rq) {
-    const URI uri = rq->getUri();
-    std::string path = uri.getPath();
-    std::unordered_map<std::string, boost::shared_ptr<Route> >::iterator end = routes.end(), it;
-    boost::shared_ptr<Route::ACL> acl;
-    bool runIt = false;
-    int handlers = 0;
-    std::ostringstream retval;
-    std::string str;
+  /* routes are registered while loading the modules, so we just rebuild everything */
+  void Router::registerRoute(const std::string &name, boost::shared_ptr<Route> route) {
+    if(routes.find(name) == routes.end()) {
+      order.push_back(name);
+    }
+
+    routes[name] = route;
+    compile();
+
+    /* a new route may match paths we already know the answer for */
+    flush();
+  }
+
+  boost::shared_ptr<const UrlTemplate> Router::getUrl(const std::string &name) const {
+    std::unordered_map<std::string, boost::shared_ptr<const UrlTemplate> >::const_iterator it = urls.find(name);
+
+    if(it == urls.end()) {
+      throw InternalErrorException("No URL template named " + name + "!", InternalErrorException::UnknownUrlError);
+    }
+
+    return it->second;
+  }
+
+  /* appends the absolute URL to out; values in the order of the template's names */
+  std::string &Router::urlFor(std::string &out, const std::string &name, const std::string *values, size_t count) const {
+    boost::shared_ptr<const UrlTemplate> tpl = getUrl(name);
+
+    out += baseURL;
+    tpl->expand(out, values, count);
+
+    return out;
+  }
+
+  std::string Router::urlFor(const std::string &name, const std::map<std::string, std::string> &vars) const {
+    boost::shared_ptr<const UrlTemplate> tpl = getUrl(name);
+    const std::vector<std::string> &names = tpl->getNames();
+    std::map<std::string, std::string>::const_iterator found;
+    std::vector<std::string> values(names.size());
+    std::string url(baseURL);
     size_t i;
-    boost::shared_ptr<pcrepp::Pcre> regex;
-    std::map<std::string, std::string> vars;
-    std::vector<Route::Pattern>::const_iterator pats_end, pats_it;
 
+    for(i = 0; i < names.size(); ++i) {
+      if((found = vars.find(names[i])) != vars.end()) {
+        values[i] = found->second;
+      }
+    }
+
+    tpl->expand(url, values.empty() ? NULL : &values[0], values.size());
 
-    for(it = routes.begin(); it != end; ++it) {
-      const std::vector<Route::Pattern> &patterns = it->second->getPatterns();
-      pats_end = patterns.end();
+    return url;
+  }
 
-      for(pats_it = patterns.begin(); pats_it != pats_end; ++pats_it) {
-        regex = pats_it->getCompiledPattern();
+  void Router::setCacheLimit(size_t limit) {
+    pthread_mutex_lock(&cacheLock);
 
-        if(regex->search(path)) {
-          const std::vector<std::string> &names = pats_it->getNames();
-          vars.clear();
+    cacheLimit = limit;
 
-          for(i = 0; i < names.size(); ++i) {
-            vars[names[i]] = (*regex)[i];
-          }
+    while(cache.size() > cacheLimit) {
+      cache.erase(cacheOrder.front());
+      cacheOrder.pop_front();
+    }
+
+    pthread_mutex_unlock(&cacheLock);
+  }
+
+  void Router::flush() {
+    pthread_mutex_lock(&cacheLock);
+
+    cache.clear();
+    cacheOrder.clear();
+
+    pthread_mutex_unlock(&cacheLock);
+  }
+
+  boost::shared_ptr<const Router::Resolution> Router::lookup(const URIPart &path) {
+    std::unordered_map<std::string, CacheSlot>::iterator it;
+    boost::shared_ptr<const Resolution> resolution;
+
+    pthread_mutex_lock(&cacheLock);
+
+    lookupKey.assign(path.data(), path.length());
+
+    if((it = cache.find(lookupKey)) != cache.end()) {
+      resolution = it->second.resolution;
+      cacheOrder.splice(cacheOrder.end(), cacheOrder, it->second.position);
+    }
+
+    pthread_mutex_unlock(&cacheLock);
+
+    return resolution;
+  }
+
+  void Router::remember(const std::string &path, boost::shared_ptr<const Resolution> resolution) {
+    std::unordered_map<std::string, CacheSlot>::iterator it;
 
-          runIt = false;
-          acl = it->second->getAcl();
+    pthread_mutex_lock(&cacheLock);
 
-          if(acl && acl->check(rq, vars)) {
-            runIt = true;
+    if(cacheLimit > 0) {
+      if((it = cache.find(path)) != cache.end()) {
+        it->second.resolution = resolution;
+      }
+      else {
+        if(cache.size() >= cacheLimit) {
+          cache.erase(cacheOrder.front());
+          cacheOrder.pop_front();
+        }
+
+        CacheSlot &slot = cache[path];
+        slot.resolution = resolution;
+        slot.position   = cacheOrder.insert(cacheOrder.end(), path);
+      }
+    }
+
+    pthread_mutex_unlock(&cacheLock);
+  }
+
+  void Router::compile() {
+    std::vector<std::string>::const_iterator it, end;
+    std::map<char, size_t>::iterator child;
+    std::string prefix;
+    size_t i, j, node;
+
+    entries.clear();
+    trie.clear();
+    trie.push_back(PrefixNode());
+
+    for(it = order.begin(), end = order.end(); it != end; ++it) {
+      boost::shared_ptr<Route> route = routes[*it];
+      const std::vector<Route::Pattern> &patterns = route->getPatterns();
+
+      for(i = 0; i < patterns.size(); ++i) {
+        boost::shared_ptr<const CompiledPattern> regex = patterns[i].getCompiledPattern();
+
+        /* a pattern that may match anywhere has to be tried for every path */
+        prefix = regex->isAnchored() ? regex->getLeadingText() : "";
+
+        for(j = 0, node = 0; j < prefix.length(); ++j) {
+          if((child = trie[node].children.find(prefix[j])) != trie[node].children.end()) {
+            node = child->second;
           }
-          else if(!acl) {
-            runIt = true;
+          else {
+            trie.push_back(PrefixNode());
+            node = trie[node].children[prefix[j]] = trie.size() - 1;
           }
+        }
 
-          if(runIt) {
-            retval << it->second->getController()->handleRequest(rq, vars);
-            ++handlers;
-          }
+        trie[node].entries.push_back(entries.size());
+        entries.push_back(MatchEntry(route, i));
+      }
+    }
+  }
+
+  boost::shared_ptr<const Router::Resolution> Router::resolve(const std::string &path) {
+    boost::shared_ptr<Resolution> resolution(boost::make_shared<Resolution>());
+    boost::shared_ptr<const CompiledPattern> regex;
+    std::map<char, size_t>::const_iterator child;
+    std::vector<size_t> candidates;
+    std::vector<size_t>::const_iterator c_it, c_end;
+    int ovector[3 * (Route::MaxCaptures + 1)], rc;
+    size_t pos, node;
+
+    resolution->path = path;
+
+    /* collect the patterns whose prefix the path starts with */
+    for(pos = 0, node = 0; ; ++pos) {
+      candidates.insert(candidates.end(), trie[node].entries.begin(), trie[node].entries.end());
+
+      if(pos >= path.length() || (child = trie[node].children.find(path[pos])) == trie[node].children.end()) {
+        break;
+      }
+
+      node = child->second;
+    }
+
+    /* handlers run in the order the routes have been registered */
+    std::sort(candidates.begin(), candidates.end());
+
+    for(c_it = candidates.begin(), c_end = candidates.end(); c_it != c_end; ++c_it) {
+      const MatchEntry &entry = entries[*c_it];
+      const Route::Pattern &pattern = entry.route->getPatterns()[entry.pattern];
+
+      regex = pattern.getCompiledPattern();
+
+      if((rc = regex->match(path.data(), path.length(), ovector, 3 * (Route::MaxCaptures + 1))) > 0) {
+        resolution->matches.push_back(Resolution::Match(entry.route));
+
+        /* a typed capture that doesn't fit is no match */
+        if(!resolution->matches.back().vars.bind(&resolution->path, pattern, ovector, rc)) {
+          resolution->matches.pop_back();
         }
       }
     }
 
+    return resolution;
+  }
+
+  std::string Router::dispatch(boost::shared_ptr<Request> rq) {
+    URIPart path = rq->getUri().getPath();
+    boost::shared_ptr<const Resolution> resolution;
+    std::vector<Resolution::Match>::const_iterator m_it, m_end;
+    boost::shared_ptr<Route::ACL> acl;
+    int handlers = 0;
+    std::string str;
+
+    if(!(resolution = lookup(path))) {
+      resolution = resolve(path.str());
+
+      /* unknown paths stay out, they'd only push out the ones we see all the time */
+      if(!resolution->matches.empty()) {
+        remember(resolution->path, resolution);
+      }
+    }
+
+    for(m_it = resolution->matches.begin(), m_end = resolution->matches.end(); m_it != m_end; ++m_it) {
+      /* ACLs look at the request, so only their absence can be cached */
+      if(m_it->aclFree || !(acl = m_it->route->getAcl()) || acl->check(rq, m_it->vars.getMap())) {
+        str += m_it->route->getController()->handleRoute(rq, m_it->vars);
+        ++handlers;
+      }
+    }
+
     if(handlers == 0) {
       throw NotFoundException("No route matched!", NotFoundException::NoRouteMatchedError);
     }
 
-    str = retval.str();
-
-    if(str.empty()) {
+    /* controllers rendering a view stream it and return nothing */
+    if(str.empty() && !rq->hasOutput()) {
       throw InternalErrorException("No output has been generated!", InternalErrorException::NoOutputGeneratedError);
     }
 
     return str;
   }
 
+  Router::~Router() {
+    pthread_mutex_destroy(&cacheLock);
+  }
+
 }
 
 
@@ -34,16 +34,26 @@
 #define ROUTER_H
 
 #include <cstdlib>
+#include <cstring>
+#include <cctype>
 #include <string>
 #include <vector>
+#include <map>
+#include <list>
 #include <sstream>
+#include <algorithm>
+
+#include <pthread.h>
 
 #include <unicode/unistr.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 
 #include "hash_map.hh"
 
+#include "framework/uri.hh"
 #include "framework/route.hh"
+#include "framework/url_template.hh"
 
 #include "framework/not_found_exception.hh"
 #include "framework/internal_error_exception.hh"
@@ -56,6 +66,7 @@ namespace CForum {
     Router();
     Router(const Router &);
     Router &operator=(const Router &);
+    ~Router();
 
     void registerRoute(const std::string &, boost::shared_ptr<Route>);
     void registerRoute(const char *, boost::shared_ptr<Route>);
@@ -63,24 +74,102 @@ namespace CForum {
 
     std::string dispatch(boost::shared_ptr<Request>);
 
+    void setCacheLimit(size_t);
+    size_t getCacheLimit() const;
+
+    void registerUrl(const std::string &, const std::string &);
+    boost::shared_ptr<const UrlTemplate> getUrl(const std::string &) const;
+    std::string &urlFor(std::string &, const std::string &, const std::string *, size_t) const;
+    std::string urlFor(const std::string &, const std::map<std::string, std::string> &) const;
+
+    void setBaseURL(const std::string &);
+    const std::string &getBaseURL() const;
+
   protected:
+    /** what a path resolved to; never changed once built */
+    class Resolution;
+
+    typedef std::list<std::string> PathList;
+
+    class CacheSlot {
+    public:
+      boost::shared_ptr<const Resolution> resolution;
+      PathList::iterator position;
+    };
+
+    /** one pattern of one route */
+    class MatchEntry {
+    public:
+      MatchEntry(boost::shared_ptr<Route>, size_t);
+
+      boost::shared_ptr<Route> route;
+      size_t pattern;
+    };
+
+    /**
+     * The routes get compiled into a trie of the fixed text the
+     * patterns start with; a pattern hangs at the node its prefix ends
+     * in, so only patterns that can match at all get to the regex
+     */
+    class PrefixNode {
+    public:
+      PrefixNode();
+
+      std::map<char, size_t> children;
+      std::vector<size_t> entries;
+    };
+
+    void compile();
+
+    boost::shared_ptr<const Resolution> resolve(const std::string &);
+    boost::shared_ptr<const Resolution> lookup(const URIPart &);
+    void remember(const std::string &, boost::shared_ptr<const Resolution>);
+    void flush();
+
     std::unordered_map<std::string, boost::shared_ptr<Route> > routes;
+    std::vector<std::string> order;
+
+    /* set up with the routes, before the router serves requests */
+    std::unordered_map<std::string, boost::shared_ptr<const UrlTemplate> > urls;
+    std::string baseURL;
+
+    std::vector<MatchEntry> entries;
+    std::vector<PrefixNode> trie;
 
+    /* most requests go to a handful of paths, so we remember what they resolved to */
+    std::unordered_map<std::string, CacheSlot> cache;
+    PathList cacheOrder;
+    volatile size_t cacheLimit;
+    std::string lookupKey; /**< reused under cacheLock, so lookups don't allocate */
+
+    pthread_mutex_t cacheLock;
   };
 
-  inline void Router::registerRoute(const std::string &name, boost::shared_ptr<Route> route) {
-    routes[name] = route;
+  inline size_t Router::getCacheLimit() const {
+    return cacheLimit;
+  }
+
+  inline void Router::registerUrl(const std::string &name, const std::string &tpl) {
+    urls[name] = boost::make_shared<UrlTemplate>(tpl);
+  }
+
+  inline void Router::setBaseURL(const std::string &base) {
+    baseURL = base;
+  }
+
+  inline const std::string &Router::getBaseURL() const {
+    return baseURL;
   }
 
   inline void Router::registerRoute(const char *name, boost::shared_ptr<Route> route) {
-    routes[std::string(name)] = route;
+    registerRoute(std::string(name), route);
   }
 
   inline void Router::registerRoute(const UnicodeString &name, boost::shared_ptr<Route> route) {
     std::string nam;
     name.toUTF8String(nam);
 
-    routes[nam] = route;
+    registerRoute(nam, route);
   }
 
 }
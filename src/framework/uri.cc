@@ -31,29 +31,29 @@
 #include "framework/uri.hh"
 
 namespace CForum {
-  URI::URI() {}
+  URI::URI() : text(), scheme(), host(), path(), pathWoSuffix(), media(), queryString(), fragment(), port(80) { }
 
-  URI::URI(const std::string &uri) {
-    parseUri(uri.c_str());
+  URI::URI(const std::string &uri) : text(uri), scheme(), host(), path(), pathWoSuffix(), media(), queryString(), fragment(), port(80) {
+    parse();
   }
 
-  URI::URI(const char *uri) {
-    parseUri(uri);
+  URI::URI(const char *uri) : text(uri), scheme(), host(), path(), pathWoSuffix(), media(), queryString(), fragment(), port(80) {
+    parse();
   }
 
-  URI::URI(const URI &uri) : scheme(uri.scheme), host(uri.host), path(uri.path),
-                             pathWoSuffix(uri.pathWoSuffix), method(uri.method),
-                             media(uri.media), queryString(uri.queryString),
-                             fragment(uri.fragment), port(uri.port) {
+  /* the spans are offsets, so they stay valid in the copied buffer */
+  URI::URI(const URI &uri) : text(uri.text), scheme(uri.scheme), host(uri.host), path(uri.path),
+                             pathWoSuffix(uri.pathWoSuffix), media(uri.media),
+                             queryString(uri.queryString), fragment(uri.fragment), port(uri.port) {
   }
 
   URI &URI::operator=(const URI &uri) {
     if(this != &uri) {
+      text         = uri.text;
       scheme       = uri.scheme;
       host         = uri.host;
       path         = uri.path;
       pathWoSuffix = uri.pathWoSuffix;
-      method       = uri.method;
       media        = uri.media;
       queryString  = uri.queryString;
       fragment     = uri.fragment;
@@ -63,40 +63,34 @@ namespace CForum {
     return *this;
   }
 
-  void URI::parseUri(const char *uri) {
-    const char *ptr, *start;
+  void URI::parse() {
+    const char *base = text.c_str(), *ptr, *start;
 
     /* set default values */
-    media       = "html";
-    port        = 80;
-    queryString = "";
-    fragment    = "";
-
-    for(start = uri, ptr = uri; *ptr; ++ptr) {
-      if(strncmp(ptr, "://", 3) == 0) {
-        scheme = std::string(start, ptr - start);
-        start  = ptr + 3;
-        ptr   += 3;
-        break;
-      }
-    }
+    scheme = host = path = pathWoSuffix = media = queryString = fragment = Span();
+    port   = 80;
 
-    if(*ptr == '\0') {
+    if((ptr = strstr(base, "://")) == NULL) {
       throw URIException("Error in URI syntax: could not find scheme", URIException::NoSchemeFound);
     }
 
-    for(; *ptr && *ptr != '/' && *ptr != ':'; ++ptr) ;
+    scheme = Span(0, ptr - base);
+    start  = ptr += 3;
+
+    if(getScheme() == "https") {
+      port = 443;
+    }
+
+    for(; *ptr && *ptr != '/' && *ptr != ':' && *ptr != '?' && *ptr != '#'; ++ptr) ;
 
     if(ptr == start) {
       throw URIException("Error in URI syntax: could not find host namme", URIException::NoHostnameFound);
     }
 
-    host = std::string(start, ptr - start);
+    host = Span(start - base, ptr - start);
 
     /* we got a string in the form of http://hostname */
     if(*ptr == '\0') {
-      path  = "/";
-      pathWoSuffix = "/";
       return;
     }
 
@@ -109,74 +103,90 @@ namespace CForum {
         throw URIException("Error in URI: expecting port number after colon after hostname!", URIException::InvalidPortNumber);
       }
     }
-    else {
-      port = 80;
-    }
 
     for(start = ptr; *ptr && *ptr != '#' && *ptr != '?'; ++ptr) ;
 
-    if(start == ptr) {
-      path = "/";
-    }
-    else {
-      path = std::string(start, ptr - start);
-    }
-
-    parsePath();
-
-    if(*ptr == '\0') {
-      return;
+    if(start != ptr) {
+      path = Span(start - base, ptr - start);
+      parsePath();
     }
 
     if(*ptr == '?') {
-      for(start = ptr; *ptr && *ptr != '#'; ++ptr) ;
-      queryString = std::string(start + 1, ptr - start - 1);
+      for(start = ++ptr; *ptr && *ptr != '#'; ++ptr) ;
+      queryString = Span(start - base, ptr - start);
     }
 
+    /* the fragment keeps its # */
     if(*ptr == '#') {
-      fragment = std::string(ptr);
+      fragment = Span(ptr - base, strlen(ptr));
     }
   }
 
   void URI::parsePath() {
-    size_t len = path.length();
-    const char *first = path.c_str(), *last = first + len - 1;
+    const char *first = text.data() + path.offset, *last = first + path.length - 1;
 
-    for(; last >= first && *last != '.' && isalnum(*last) && islower(*last); --last) ;
+    for(; last > first && *last != '.' && isalnum(*last) && islower(*last); --last) ;
 
     if(*last == '.') {
-      media        = std::string(last + 1);
-      pathWoSuffix = std::string(first, last - first);
+      media        = Span(last + 1 - text.data(), path.length - (last + 1 - first));
+      pathWoSuffix = Span(path.offset, last - first);
     }
     else {
-      pathWoSuffix = first;
+      pathWoSuffix = path;
     }
   }
 
-  std::string URI::toString() {
-    return ((const URI *)this)->toString();
-  }
+  /* works like snprintf: returns the full length, writes at most size - 1 bytes and a 0 byte */
+  size_t URI::toString(char *buff, size_t size) const {
+    URIPart parts[5] = { getScheme(), getHost(), getPath(), getQueryString(), getFragment() };
+    const char *seps[5] = { "", "://", NULL, "?", "" };
+    char portbuff[16] = "";
+    size_t len = 0, i, n;
 
-  std::string URI::toString() const {
-    std::ostringstream ostr;
+    if((getScheme() == "http" && port != 80) || (getScheme() == "https" && port != 443)) {
+      snprintf(portbuff, sizeof(portbuff), ":%d", port);
+    }
 
-    ostr << scheme << "://" << host;
+    for(i = 0; i < 5; ++i) {
+      /* the query separator only comes with a query */
+      if(i == 3 && parts[i].empty()) {
+        continue;
+      }
 
-    if((scheme == "http" && port != 80) || (scheme == "https" && port != 443)) {
-      ostr << ":" << port;
-    }
+      const char *sep = seps[i] ? seps[i] : portbuff;
+      const char *pieces[2] = { sep, parts[i].data() };
+      size_t lengths[2] = { strlen(sep), parts[i].length() };
+
+      for(n = 0; n < 2; ++n) {
+        if(len < size) {
+          memcpy(buff + len, pieces[n], std::min(lengths[n], size - len));
+        }
 
-    ostr << path;
+        len += lengths[n];
+      }
+    }
 
-    if(queryString.length()) {
-      ostr << "?" << queryString;
+    if(size > 0) {
+      buff[std::min(len, size - 1)] = '\0';
     }
 
-    if(fragment.length()) {
-      ostr << fragment;
+    return len;
+  }
+
+  std::string URI::toString() const {
+    std::string str;
+    char buff[256];
+    size_t len = toString(buff, sizeof(buff));
+
+    if(len < sizeof(buff)) {
+      return std::string(buff, len);
     }
 
-    return ostr.str();
+    str.resize(len + 1);
+    toString(&str[0], str.length());
+    str.resize(len);
+
+    return str;
   }
 
   URI::~URI() { }
@@ -33,13 +33,44 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#include <cctype>
 #include <string>
-#include <sstream>
 #include <iostream>
+#include <algorithm>
 
 #include "framework/uri_exception.hh"
 
 namespace CForum {
+  /** a component of a URI; only valid as long as the URI it came from */
+  class URIPart {
+  public:
+    URIPart();
+    URIPart(const char *, size_t);
+
+    const char *data() const;
+    size_t length() const;
+    bool empty() const;
+
+    std::string str() const;
+    operator std::string() const;
+
+    bool operator==(const char *) const;
+    bool operator==(const std::string &) const;
+    bool operator!=(const char *) const;
+    bool operator!=(const std::string &) const;
+
+  private:
+    const char *ptr;
+    size_t len;
+  };
+
+  std::ostream &operator<<(std::ostream &, const URIPart &);
+
+  /**
+   * The URI text lives in one buffer; parsing only remembers where the
+   * components start and end, the getters hand out views of them
+   */
   class URI {
   public:
     URI();
@@ -47,115 +78,142 @@ namespace CForum {
     URI(const char *);
     URI(const URI &);
 
-    const std::string &getScheme();
-    const std::string &getHost();
-    int getPort();
-    const std::string &getPath();
-    const std::string &getPathWoSuffix();
-    const std::string &getMethod();
-    const std::string &getQueryString();
-    const std::string &getFragment();
-    const std::string &getMedia();
-
-    const std::string &getScheme() const;
-    const std::string &getHost() const;
+    URIPart getScheme() const;
+    URIPart getHost() const;
     int getPort() const;
-    const std::string &getPath() const;
-    const std::string &getPathWoSuffix() const;
-    const std::string &getMethod() const;
-    const std::string &getQueryString() const;
-    const std::string &getFragment() const;
-    const std::string &getMedia() const;
+    URIPart getPath() const;
+    URIPart getPathWoSuffix() const;
+    URIPart getMethod() const;
+    URIPart getQueryString() const;
+    URIPart getFragment() const;
+    URIPart getMedia() const;
 
     URI &operator=(const URI &);
 
-    std::string toString();
+    std::string &buffer();
+    void parse();
+
+    size_t toString(char *, size_t) const;
     std::string toString() const;
 
     ~URI();
 
   protected:
-    std::string scheme, host, path, pathWoSuffix, method, media, queryString, fragment;
-    int port;
+    /** offset and length in the buffer; NoSpan as offset if the URI doesn't have it */
+    class Span {
+    public:
+      Span();
+      Span(size_t, size_t);
 
-    void parseUri(const char *);
+      size_t offset, length;
+    };
+
+    static const size_t NoSpan = (size_t)-1;
+
+    URIPart part(const Span &, const char *) const;
     void parsePath();
+
+    std::string text;
+    Span scheme, host, path, pathWoSuffix, media, queryString, fragment;
+    int port;
   };
 
-  /* getters */
+  inline URIPart::URIPart() : ptr(""), len(0) { }
+  inline URIPart::URIPart(const char *p, size_t l) : ptr(p), len(l) { }
 
-  inline const std::string &URI::getScheme() {
-    return scheme;
+  inline const char *URIPart::data() const {
+    return ptr;
   }
 
-  inline const std::string &URI::getHost() {
-    return host;
+  inline size_t URIPart::length() const {
+    return len;
   }
 
-  inline int URI::getPort() {
-    return port;
+  inline bool URIPart::empty() const {
+    return len == 0;
+  }
+
+  inline std::string URIPart::str() const {
+    return std::string(ptr, len);
+  }
+
+  inline URIPart::operator std::string() const {
+    return str();
   }
 
-  inline const std::string &URI::getPath() {
-    return path;
+  inline bool URIPart::operator==(const char *other) const {
+    return strlen(other) == len && memcmp(ptr, other, len) == 0;
   }
 
-  inline const std::string &URI::getPathWoSuffix() {
-    return pathWoSuffix;
+  inline bool URIPart::operator==(const std::string &other) const {
+    return other.length() == len && memcmp(ptr, other.data(), len) == 0;
   }
 
-  inline const std::string &URI::getMethod() {
-    return method;
+  inline bool URIPart::operator!=(const char *other) const {
+    return !(*this == other);
   }
 
-  inline const std::string &URI::getQueryString() {
-    return queryString;
+  inline bool URIPart::operator!=(const std::string &other) const {
+    return !(*this == other);
   }
 
-  inline const std::string &URI::getFragment() {
-    return fragment;
+  inline std::ostream &operator<<(std::ostream &os, const URIPart &part) {
+    return os.write(part.data(), part.length());
   }
 
-  inline const std::string &URI::getMedia() {
-    return media;
+  inline URI::Span::Span() : offset(NoSpan), length(0) { }
+  inline URI::Span::Span(size_t off, size_t len) : offset(off), length(len) { }
+
+  /* a missing component falls back to its default */
+  inline URIPart URI::part(const Span &span, const char *fallback) const {
+    if(span.offset == NoSpan) {
+      return fallback ? URIPart(fallback, strlen(fallback)) : URIPart();
+    }
+
+    return URIPart(text.data() + span.offset, span.length);
   }
 
-  /* const getters */
+  /* getters */
 
-  inline const std::string &URI::getScheme() const {
-    return scheme;
+  inline URIPart URI::getScheme() const {
+    return part(scheme, NULL);
   }
 
-  inline const std::string &URI::getHost() const {
-    return host;
+  inline URIPart URI::getHost() const {
+    return part(host, NULL);
   }
 
   inline int URI::getPort() const {
     return port;
   }
 
-  inline const std::string &URI::getPath() const {
-    return path;
+  inline URIPart URI::getPath() const {
+    return part(path, "/");
+  }
+
+  inline URIPart URI::getPathWoSuffix() const {
+    return part(pathWoSuffix, "/");
   }
 
-  inline const std::string &URI::getPathWoSuffix() const {
-    return pathWoSuffix;
+  inline URIPart URI::getMethod() const {
+    return URIPart();
   }
 
-  inline const std::string &URI::getMethod() const {
-    return method;
+  inline URIPart URI::getQueryString() const {
+    return part(queryString, NULL);
   }
 
-  inline const std::string &URI::getQueryString() const {
-    return queryString;
+  inline URIPart URI::getFragment() const {
+    return part(fragment, NULL);
   }
 
-  inline const std::string &URI::getFragment() const {
-    return fragment;
+  inline URIPart URI::getMedia() const {
+    return part(media, "html");
   }
 
-  inline const std::string &URI::getMedia() const {
-    return media;
+  /** write the URI text here and call parse(), saves a copy */
+  inline std::string &URI::buffer() {
+    return text;
   }
 
 }
@@ -0,0 +1,139 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief URL template implementation
+ * \package framework
+ *
+ * A URL with <name> placeholders, split up once so that building a URL
+ * is a few appends
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "framework/url_template.hh"
+
+namespace CForum {
+  UrlTemplate::Segment::Segment(const std::string &lit, size_t var, bool pth) : literal(lit), variable(var), path(pth) { }
+
+  UrlTemplate::UrlTemplate(const std::string &tpl) : segments(), names(), literalLength(0) {
+    std::string literal, name;
+    size_t pos = 0, open, close, colon, i;
+    bool path;
+
+    while((open = tpl.find('<', pos)) != std::string::npos) {
+      if((close = tpl.find('>', open)) == std::string::npos) {
+        throw RouteSyntaxException("Error: <name> in URL template is not closed!", RouteSyntaxException::NamedPatternNotClosedError);
+      }
+
+      literal = tpl.substr(pos, open - pos);
+      name    = tpl.substr(open + 1, close - open - 1);
+      path    = false;
+
+      if((colon = name.find(':')) != std::string::npos) {
+        if(name.compare(colon + 1, std::string::npos, "path") != 0) {
+          throw RouteSyntaxException("Error: unknown type in URL template, only <name:path> is known!", RouteSyntaxException::NamedPatternIdInvalidError);
+        }
+
+        path = true;
+        name.erase(colon);
+      }
+
+      if(name.empty()) {
+        throw RouteSyntaxException("Error: empty <name> in URL template!", RouteSyntaxException::NamedPatternIdInvalidError);
+      }
+
+      /* a name may appear more than once, it's still one value */
+      if((i = indexOf(name)) == NoVariable) {
+        i = names.size();
+        names.push_back(name);
+      }
+
+      segments.push_back(Segment(literal, i, path));
+      literalLength += literal.length();
+
+      pos = close + 1;
+    }
+
+    if(pos < tpl.length()) {
+      segments.push_back(Segment(tpl.substr(pos), NoVariable, false));
+      literalLength += tpl.length() - pos;
+    }
+  }
+
+  size_t UrlTemplate::indexOf(const std::string &name) const {
+    size_t i;
+
+    for(i = 0; i < names.size(); ++i) {
+      if(names[i] == name) {
+        return i;
+      }
+    }
+
+    return NoVariable;
+  }
+
+  /* path segment rules: unreserved and sub-delims stay, everything else gets escaped; a path keeps its slashes */
+  void UrlTemplate::appendEncoded(std::string &out, const std::string &value, bool path) {
+    static const char hex[] = "0123456789ABCDEF";
+    const char *ptr = value.data(), *end = ptr + value.length(), *start = ptr;
+    unsigned char c;
+
+    for(; ptr < end; ++ptr) {
+      c = (unsigned char)*ptr;
+
+      if(isalnum(c) || (path && c == '/') || (c != '\0' && strchr("-._~!$&'()*+,;=:@", c) != NULL)) {
+        continue;
+      }
+
+      out.append(start, ptr - start);
+      out += '%';
+      out += hex[c >> 4];
+      out += hex[c & 0xF];
+      start = ptr + 1;
+    }
+
+    out.append(start, end - start);
+  }
+
+  /* values are given by index, in the order of getNames(); missing ones are empty */
+  void UrlTemplate::expand(std::string &out, const std::string *values, size_t count) const {
+    std::vector<Segment>::const_iterator it, end;
+    size_t len = literalLength, i;
+
+    for(i = 0; i < count; ++i) {
+      len += values[i].length();
+    }
+
+    out.reserve(out.length() + len);
+
+    for(it = segments.begin(), end = segments.end(); it != end; ++it) {
+      out += it->literal;
+
+      if(it->variable != NoVariable && it->variable < count) {
+        appendEncoded(out, values[it->variable], it->path);
+      }
+    }
+  }
+
+}
+
+/* eof */
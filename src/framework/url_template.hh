@@ -0,0 +1,80 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief URL template interface
+ * \package framework
+ *
+ * A URL with <name> placeholders, split up once so that building a URL
+ * is a few appends
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef URL_TEMPLATE_H
+#define URL_TEMPLATE_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cctype>
+
+#include "framework/route_syntax_exception.hh"
+
+namespace CForum {
+  class UrlTemplate {
+  public:
+    UrlTemplate(const std::string &);
+
+    const std::vector<std::string> &getNames() const;
+    size_t indexOf(const std::string &) const;
+
+    void expand(std::string &, const std::string *, size_t) const;
+
+    static void appendEncoded(std::string &, const std::string &, bool = false);
+
+  protected:
+    /** literal text, followed by the value of a variable unless it's NoVariable */
+    class Segment {
+    public:
+      Segment(const std::string &, size_t, bool);
+
+      std::string literal;
+      size_t variable;
+      bool path; /**< <name:path> keeps slashes, the value is a path of its own */
+    };
+
+    static const size_t NoVariable = (size_t)-1;
+
+    std::vector<Segment> segments;
+    std::vector<std::string> names;
+    size_t literalLength;
+  };
+
+  inline const std::vector<std::string> &UrlTemplate::getNames() const {
+    return names;
+  }
+
+}
+
+#endif
+
+/* eof */
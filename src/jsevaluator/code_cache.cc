@@ -0,0 +1,154 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Code cache implementation; persists V8 pre-parse data on disk
+ * \package JSEvaluator
+ *
+ * The code cache stores the V8 pre-parse data of compiled scripts in a cache
+ * directory and feeds it back when the same source gets compiled again
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "jsevaluator/code_cache.hh"
+
+namespace CForum {
+  std::string CodeCache::_directory;
+  pthread_once_t CodeCache::_directoryOnce = PTHREAD_ONCE_INIT;
+  pthread_mutex_t CodeCache::_directoryLock = PTHREAD_MUTEX_INITIALIZER;
+
+  CodeCache::Data::Data() : _buffer(), _data(NULL) { }
+
+  CodeCache::Data::~Data() {
+    delete _data;
+  }
+
+  /* the config file itself is compiled before we know the config, so the environment comes first */
+  void CodeCache::initDirectory() {
+    const char *env = getenv("CF_CODE_CACHE");
+
+    if(env != NULL) {
+      _directory = env;
+    }
+  }
+
+  void CodeCache::setDirectory(const std::string &dir) {
+    pthread_once(&_directoryOnce, initDirectory);
+
+    pthread_mutex_lock(&_directoryLock);
+    _directory = dir;
+    pthread_mutex_unlock(&_directoryLock);
+  }
+
+  std::string CodeCache::getDirectory() {
+    std::string dir;
+
+    pthread_once(&_directoryOnce, initDirectory);
+
+    pthread_mutex_lock(&_directoryLock);
+    dir = _directory;
+    pthread_mutex_unlock(&_directoryLock);
+
+    return dir;
+  }
+
+  std::string CodeCache::generateKey(const std::string &source) {
+    /* FNV-1a over the V8 version and the source; the data is only valid for the exact same input */
+    const char *version = v8::V8::GetVersion();
+    unsigned long long hash = 14695981039346656037ULL;
+    std::ostringstream ostr;
+    size_t i;
+
+    for(; *version; ++version) {
+      hash = (hash ^ (unsigned char)*version) * 1099511628211ULL;
+    }
+
+    for(i = 0; i < source.length(); ++i) {
+      hash = (hash ^ (unsigned char)source[i]) * 1099511628211ULL;
+    }
+
+    ostr << std::hex << hash << "-" << source.length();
+    return ostr.str();
+  }
+
+  boost::shared_ptr<CodeCache::Data> CodeCache::lookup(const std::string &source) {
+    std::string dir = getDirectory();
+    boost::shared_ptr<Data> data;
+
+    if(dir.empty()) {
+      return data;
+    }
+
+    std::string fname = dir + "/" + generateKey(source) + ".v8pd";
+    std::ifstream in(fname.c_str(), std::ifstream::in | std::ifstream::binary);
+
+    data = boost::make_shared<Data>();
+
+    if(in) {
+      std::ostringstream sst;
+      sst << in.rdbuf();
+      in.close();
+
+      std::string str = sst.str();
+
+      if(!str.empty()) {
+        /* V8 may reference the buffer instead of copying it, so the buffer lives as long as the data */
+        data->_buffer.assign(str.begin(), str.end());
+        data->_data = v8::ScriptData::New(&data->_buffer[0], (int)data->_buffer.size());
+
+        if(data->_data != NULL && !data->_data->HasError()) {
+          return data;
+        }
+
+        delete data->_data;
+        data->_data = NULL;
+      }
+    }
+
+    data->_data = v8::ScriptData::PreCompile(source.c_str(), (int)source.length());
+
+    if(data->_data == NULL || data->_data->HasError()) {
+      return boost::shared_ptr<Data>();
+    }
+
+    /* write to a temporary file and rename it, so that concurrent workers never read partial files */
+    std::string tmpname = fname + ".XXXXXX";
+    std::vector<char> tmpl(tmpname.begin(), tmpname.end());
+    tmpl.push_back('\0');
+
+    int fd = mkstemp(&tmpl[0]);
+
+    if(fd != -1) {
+      ssize_t written = write(fd, data->_data->Data(), data->_data->Length());
+      close(fd);
+
+      if(written != data->_data->Length() || rename(&tmpl[0], fname.c_str()) != 0) {
+        unlink(&tmpl[0]);
+      }
+    }
+
+    return data;
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,95 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Code cache interface; persists V8 pre-parse data on disk
+ * \package JSEvaluator
+ *
+ * The code cache stores the V8 pre-parse data of compiled scripts in a cache
+ * directory and feeds it back when the same source gets compiled again
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CODE_CACHE_H
+#define CODE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <pthread.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include <v8.h>
+
+namespace CForum {
+  class CodeCache {
+  public:
+    class Data {
+    public:
+      Data();
+      ~Data();
+
+      v8::ScriptData *get();
+
+    private:
+      Data(const Data &);
+      Data &operator=(const Data &);
+
+      std::vector<char> _buffer;
+      v8::ScriptData *_data;
+
+      friend class CodeCache;
+    };
+
+    static boost::shared_ptr<Data> lookup(const std::string &);
+
+    static void setDirectory(const std::string &);
+    static std::string getDirectory();
+
+    static std::string generateKey(const std::string &);
+
+  private:
+    static void initDirectory();
+
+    /* templates are compiled on several threads while a reload may set the directory */
+    static std::string _directory;
+    static pthread_once_t _directoryOnce;
+    static pthread_mutex_t _directoryLock;
+  };
+
+  inline v8::ScriptData *CodeCache::Data::get() {
+    return _data;
+  }
+
+}
+
+#endif
+
+/* eof */
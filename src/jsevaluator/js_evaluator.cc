@@ -62,7 +62,8 @@ namespace CForum {
 
   v8::Local<v8::Script> JSEvaluator::compileString(const std::string &source) {
     v8::Local<v8::String> src = v8::String::New(source.c_str());
-    v8::Local<v8::Script> script = v8::Script::Compile(src);
+    boost::shared_ptr<CodeCache::Data> data = CodeCache::lookup(source);
+    v8::Local<v8::Script> script = v8::Script::Compile(src, NULL, data ? data->get() : NULL);
 
     return script;
   }
@@ -39,6 +39,7 @@
 #include <sstream>
 
 #include "jsevaluator/js_evaluator_exception.hh"
+#include "jsevaluator/code_cache.hh"
 
 namespace CForum {
   class JSEvaluator {
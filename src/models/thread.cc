@@ -31,8 +31,11 @@
 
 namespace CForum {
   namespace Models {
-    Thread::Thread() : Model(), id(), tid(), messages(), archived(false) { }
-    Thread::Thread(const Thread &t) : Model(), id(t.id), tid(t.tid), messages(t.messages), archived(t.archived) { } // TODO: create a COPY of t.messages
+    static const char MetaCollection[] = "meta";
+    static const char ThreadlistStamp[] = "threadlist";
+
+    Thread::Thread() : Model(), id(), tid(), messages(), archived(false), version(0), modified(0) { }
+    Thread::Thread(const Thread &t) : Model(), id(t.id), tid(t.tid), messages(t.messages), archived(t.archived), version(t.version), modified(t.modified) { } // TODO: create a COPY of t.messages
 
     Thread &Thread::operator=(const Thread &t) {
       if(this != &t) {
@@ -40,6 +43,8 @@ namespace CForum {
         id       = t.id;
         messages = t.messages;  // TODO: create a COPY of messages
         archived = t.archived;
+        version  = t.version;
+        modified = t.modified;
       }
 
       return *this;
@@ -58,6 +63,14 @@ namespace CForum {
       t->id       = o.getField("_id").String();
       t->archived = o.getField("archived").Bool();
 
+      /* threads written before versioning simply have version 0 */
+      if(o.hasField("version")) {
+        t->version = o.getField("version").numberLong();
+      }
+      if(o.hasField("modified")) {
+        t->modified = (time_t)(o.getField("modified").Date() / 1000);
+      }
+
       const std::vector<mongo::BSONElement> msgs = o.getField("messages").Array();
       std::vector<mongo::BSONElement>::const_iterator it, end = msgs.end();
       for(it = msgs.begin(); it != end; ++it) {
@@ -81,6 +94,8 @@ namespace CForum {
       t->Set(v8::String::New("id"), v8::String::New(id.c_str()));
       t->Set(v8::String::New("tid"), v8::String::New(tid.c_str()));
       t->Set(v8::String::New("archived"), v8::Boolean::New(archived));
+      t->Set(v8::String::New("version"), v8::Number::New((double)version));
+      t->Set(v8::String::New("modified"), v8::Date::New((uint64_t)modified * 1000));
 
       v8::Local<v8::Array> ary = v8::Array::New();
       std::vector<boost::shared_ptr<Message> >::iterator it, end = messages.end();
@@ -94,6 +109,34 @@ namespace CForum {
       return t;
     }
 
+    void Thread::touch(boost::shared_ptr<DBClientConnection> conn, const std::string &id) {
+      mongo::Date_t now((unsigned long long)time(NULL) * 1000);
+
+      conn->update("threads", QUERY("_id" << id), BSON("$inc" << BSON("version" << 1) << "$set" << BSON("modified" << now)));
+      conn->update(MetaCollection, QUERY("_id" << ThreadlistStamp), BSON("$inc" << BSON("version" << 1) << "$set" << BSON("modified" << now)), true);
+    }
+
+    bool Thread::getListStamp(boost::shared_ptr<DBClientConnection> conn, long long &version, time_t &modified) {
+      std::auto_ptr<mongo::DBClientCursor> cursor = conn->query(MetaCollection, QUERY("_id" << ThreadlistStamp), 1);
+      mongo::BSONObj obj;
+
+      if(!cursor->more()) {
+        return false;
+      }
+
+      obj = cursor->next();
+
+      /* a half written stamp is as good as none */
+      if(!obj.hasField("version") || !obj.hasField("modified")) {
+        return false;
+      }
+
+      version  = obj.getField("version").numberLong();
+      modified = (time_t)(obj.getField("modified").Date() / 1000);
+
+      return true;
+    }
+
     boost::shared_ptr<Message> Thread::getMessage(const std::string &id) {
       if(messages.empty()) {
         return boost::shared_ptr<Message>();
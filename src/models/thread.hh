@@ -30,6 +30,8 @@
 #ifndef THREAD_H
 #define THREAD_H
 
+#include <ctime>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 
@@ -60,9 +62,19 @@ namespace CForum {
       virtual boost::shared_ptr<mongo::BSONObj> toBSON();
       virtual v8::Local<v8::Object> toV8();
 
+      /**
+       * Bumps the version and modification time of a thread and of the
+       * thread list; every write to a thread has to call this
+       */
+      static void touch(boost::shared_ptr<DBClientConnection>, const std::string &);
+      static bool getListStamp(boost::shared_ptr<DBClientConnection>, long long &, time_t &);
+
       std::string id, tid;
       std::vector<boost::shared_ptr<Message> > messages;
       bool archived;
+
+      long long version;
+      time_t modified;
     };
   }
 }
@@ -180,13 +180,13 @@ namespace CForum {
       vars = args[1]->ToObject();
     }
 
-    *tpl->getStream() << tpl->evaluateFile(fname, vars);
+    tpl->renderFile(fname, *tpl->getStream(), vars);
 
     return v8::Undefined();
   }
 
 
-  Template::Template() : _stream(NULL), _extends(), _base_dir() {
+  Template::Template() : _stream(NULL), _extends(), _base_dir(), _cache(NULL) {
     v8::HandleScope scope;
 
     _global = v8::ObjectTemplate::New();
@@ -205,9 +205,10 @@ namespace CForum {
     _vars = v8::Object::New();
 
     v8::Local<v8::Object>::Cast(_context->Global()->GetPrototype())->SetInternalField(0, v8::External::New(this));
+    recordBaselineGlobals();
   }
 
-  Template::Template(v8::ExtensionConfiguration *ext) : _stream(NULL), _extends(), _base_dir() {
+  Template::Template(v8::ExtensionConfiguration *ext) : _stream(NULL), _extends(), _base_dir(), _cache(NULL) {
     v8::HandleScope scope;
 
     _global = v8::ObjectTemplate::New();
@@ -226,6 +227,48 @@ namespace CForum {
     _vars = v8::Object::New();
 
     v8::Local<v8::Object>::Cast(_context->Global()->GetPrototype())->SetInternalField(0, v8::External::New(this));
+    recordBaselineGlobals();
+  }
+
+  void Template::recordBaselineGlobals() {
+    v8::Local<v8::Array> keys = _context->Global()->GetPropertyNames();
+
+    for(uint32_t i = 0; i < keys->Length(); ++i) {
+      v8::String::Utf8Value name(keys->Get(i));
+      _baseline_globals.insert(*name);
+    }
+  }
+
+  void Template::enter() {
+    if(!_scope) {
+      _scope = boost::make_shared<v8::Context::Scope>(_context);
+    }
+  }
+
+  void Template::leave() {
+    _scope.reset();
+  }
+
+  void Template::reset() {
+    {
+      v8::HandleScope scope;
+      v8::Local<v8::Object> global = _context->Global();
+      v8::Local<v8::Array> keys = global->GetPropertyNames();
+
+      /* drop everything the last request (or its templates) put into the global object */
+      for(uint32_t i = 0; i < keys->Length(); ++i) {
+        v8::Local<v8::Value> key = keys->Get(i);
+        v8::String::Utf8Value name(key);
+
+        if(_baseline_globals.find(*name) == _baseline_globals.end()) {
+          global->ForceDelete(key);
+        }
+      }
+    }
+
+    _vars    = v8::Object::New();
+    _extends = Extender();
+    _stream  = NULL;
   }
 
   void Template::setGlobal(const char *nam, v8::Handle<v8::Value> val) {
@@ -250,6 +293,28 @@ namespace CForum {
   }
 
   std::string Template::evaluate(const v8::Local<v8::Script> &script, v8::Local<v8::Object> vars) {
+    std::ostringstream ostr;
+
+    render(script, ostr, vars);
+    return ostr.str();
+  }
+
+  void Template::renderFile(const std::string &fname, std::ostream &out, v8::Local<v8::Object> vars) {
+    v8::HandleScope scope;
+    bool may_extend = true;
+    v8::Local<v8::Script> script;
+
+    if(_cache) {
+      script = _cache->getScript(fname, this, &may_extend);
+    }
+    else {
+      script = compile(parseFile(fname, &may_extend));
+    }
+
+    render(script, out, vars, may_extend);
+  }
+
+  void Template::render(const v8::Local<v8::Script> &script, std::ostream &out, v8::Local<v8::Object> vars, bool may_extend) {
     v8::HandleScope scope;
 
     std::ostringstream ostr;
@@ -275,14 +340,27 @@ namespace CForum {
     tmp_vars = _vars;
     _vars = vars;
 
+    /*
+     * only the output of a template extending another one is needed as a
+     * string; everything else goes straight to the caller's stream
+     */
     tmp = _stream;
-    _stream = &ostr;
+    _stream = may_extend ? &ostr : &out;
     script->Run();
     _stream = tmp;
 
-    str = ostr.str();
+    /* extend() reached through a helper: the output went out already, the layout can't wrap it */
+    if(!may_extend && !_extends.isEmpty()) {
+      fname = _extends.getFilename();
+      _extends = Extender();
+      _vars = tmp_vars;
+
+      throw TemplateException("extend(\"" + fname + "\") has to be called by the template itself, not through a helper", TemplateException::ExtendError);
+    }
 
     if(!_extends.isEmpty()) {
+      str = ostr.str();
+
       e_vars = _extends.getVars();
       if(!e_vars.IsEmpty()) {
         keys = e_vars->GetPropertyNames();
@@ -293,21 +371,20 @@ namespace CForum {
         }
       }
 
-      vars->Set(v8::String::New("_content"),v8::String::New(str.c_str()));
+      vars->Set(v8::String::New("_content"),v8::String::New(str.c_str(), (int)str.length()));
       _vars = vars;
 
       fname = _extends.getFilename();
       _extends = Extender();
 
-      tmp = _stream;
-      _stream = &ostr;
-      str = evaluateFile(fname);
-      _stream = tmp;
+      renderFile(fname, out);
+    }
+    else if(may_extend) {
+      str = ostr.str();
+      out.write(str.data(), (std::streamsize)str.length());
     }
 
     _vars = tmp_vars;
-
-    return str;
   }
 
   Template::~Template() {
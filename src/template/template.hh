@@ -43,12 +43,15 @@
 
 #include <string>
 #include <vector>
+#include <set>
 
 #include <v8.h>
 
 #include <cstring>
+#include <cctype>
 
 #include "template/template_exception.hh"
+#include "template/template_cache.hh"
 #include "template/template_parser_exception.hh"
 
 #include "json/json_parser.hh"
@@ -59,11 +62,11 @@ namespace CForum {
     Template();
     Template(v8::ExtensionConfiguration *);
 
-    std::string parseFile(const std::string &);
+    std::string parseFile(const std::string &, bool * = NULL);
 
     std::string parseString(const std::string &);
     std::string parseString(const UnicodeString &);
-    std::string parseString(const char *,size_t);
+    std::string parseString(const char *,size_t,bool * = NULL);
 
     std::string evaluateFile(const std::string &, v8::Local<v8::Object> = v8::Local<v8::Object>());
     std::string evaluateString(const std::string &, v8::Local<v8::Object> = v8::Local<v8::Object>());
@@ -71,6 +74,9 @@ namespace CForum {
     std::string evaluate(const std::string &, v8::Local<v8::Object> = v8::Local<v8::Object>());
     std::string evaluate(const v8::Local<v8::Script> &, v8::Local<v8::Object> = v8::Local<v8::Object>());
 
+    void renderFile(const std::string &, std::ostream &, v8::Local<v8::Object> = v8::Local<v8::Object>());
+    void render(const v8::Local<v8::Script> &, std::ostream &, v8::Local<v8::Object> = v8::Local<v8::Object>(), bool = true);
+
     v8::Local<v8::Script> compile(const std::string &);
 
     void setVariable(const UnicodeString &, v8::Local<v8::Value>);
@@ -93,6 +99,13 @@ namespace CForum {
 
     void setGlobal(const char *, v8::Handle<v8::Value>);
 
+    void enter();
+    void leave();
+    void reset();
+
+    void setCache(TemplateCache *);
+    TemplateCache *getCache();
+
     ~Template();
 
   private:
@@ -126,6 +139,10 @@ namespace CForum {
     v8::Local<v8::Object> _vars;
     std::string _base_dir;
     boost::shared_ptr<v8::Context::Scope> _scope;
+    std::set<std::string> _baseline_globals;
+    TemplateCache *_cache;
+
+    void recordBaselineGlobals();
   };
 
   inline std::string Template::parseString(const std::string &str) {
@@ -140,9 +157,21 @@ namespace CForum {
   }
 
   inline std::string Template::evaluateFile(const std::string &fname, v8::Local<v8::Object> vars) {
+    if(_cache) {
+      return evaluate(_cache->getScript(fname, this), vars);
+    }
+
     return evaluate(parseFile(fname), vars);
   }
 
+  inline void Template::setCache(TemplateCache *cache) {
+    _cache = cache;
+  }
+
+  inline TemplateCache *Template::getCache() {
+    return _cache;
+  }
+
   inline std::string Template::evaluateString(const std::string &str, v8::Local<v8::Object> vars) {
     return evaluate(parseString(str), vars);
   }
@@ -0,0 +1,169 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Template cache implementation; caches translated and compiled templates
+ * \package template
+ *
+ * The template cache keeps the translated JavaScript source of template files
+ * (process wide) and the compiled, context independent scripts (per isolate),
+ * keyed by the file path and invalidated by device, inode, size and mtime
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "template/template_cache.hh"
+#include "template/template.hh"
+
+namespace CForum {
+  std::unordered_map<std::string, TemplateCache::SourceEntry> TemplateCache::_sources;
+  pthread_mutex_t TemplateCache::_sources_lock = PTHREAD_MUTEX_INITIALIZER;
+
+  TemplateCache::FileStamp::FileStamp() : device(0), inode(0), size(0), mtime(0) { }
+
+  bool TemplateCache::FileStamp::fromFile(const std::string &path) {
+    struct stat st;
+
+    if(stat(path.c_str(), &st) != 0) {
+      return false;
+    }
+
+    device = st.st_dev;
+    inode  = st.st_ino;
+    size   = st.st_size;
+    mtime  = st.st_mtime;
+
+    return true;
+  }
+
+  bool TemplateCache::FileStamp::operator==(const FileStamp &other) const {
+    return device == other.device && inode == other.inode && size == other.size && mtime == other.mtime;
+  }
+
+  bool TemplateCache::FileStamp::operator!=(const FileStamp &other) const {
+    return !(*this == other);
+  }
+
+  TemplateCache::TemplateCache(bool check_mtime) : _check_mtime(check_mtime), _scripts() { }
+
+  std::string TemplateCache::getSource(const std::string &path, const FileStamp &stamp, Template *parser, bool *extends) {
+    std::unordered_map<std::string, SourceEntry>::iterator it;
+    std::string source;
+
+    pthread_mutex_lock(&_sources_lock);
+    it = _sources.find(path);
+
+    if(it != _sources.end() && (!_check_mtime || it->second.stamp == stamp)) {
+      source   = it->second.source;
+      *extends = it->second.extends;
+      pthread_mutex_unlock(&_sources_lock);
+
+      return source;
+    }
+
+    pthread_mutex_unlock(&_sources_lock);
+
+    /* parse without holding the lock; parseFile() throws when the file is gone */
+    source = parser->parseFile(path, extends);
+
+    pthread_mutex_lock(&_sources_lock);
+    SourceEntry &entry = _sources[path];
+    entry.stamp   = stamp;
+    entry.source  = source;
+    entry.extends = *extends;
+    pthread_mutex_unlock(&_sources_lock);
+
+    return source;
+  }
+
+  v8::Local<v8::Script> TemplateCache::getScript(const std::string &path, Template *parser, bool *may_extend) {
+    std::unordered_map<std::string, ScriptEntry>::iterator it = _scripts.find(path);
+    FileStamp stamp;
+
+    if(it != _scripts.end() && !_check_mtime) {
+      if(may_extend) {
+        *may_extend = it->second.extends;
+      }
+
+      return v8::Local<v8::Script>::New(it->second.script);
+    }
+
+    stamp.fromFile(path);
+
+    if(it != _scripts.end() && it->second.stamp == stamp) {
+      if(may_extend) {
+        *may_extend = it->second.extends;
+      }
+
+      return v8::Local<v8::Script>::New(it->second.script);
+    }
+
+    bool extends = false;
+    std::string source = getSource(path, stamp, parser, &extends);
+
+    /* context independent, so every template context of this isolate may run it */
+    v8::ScriptOrigin origin(v8::String::New(path.c_str()));
+    boost::shared_ptr<CodeCache::Data> data = CodeCache::lookup(source);
+    v8::Local<v8::Script> script = v8::Script::New(v8::String::New(source.c_str(), source.length()), &origin, data ? data->get() : NULL);
+
+    if(script.IsEmpty()) {
+      throw TemplateException("Error compiling template " + path, TemplateException::CompileError);
+    }
+
+    ScriptEntry &entry = _scripts[path];
+    if(!entry.script.IsEmpty()) {
+      entry.script.Dispose();
+    }
+
+    entry.stamp   = stamp;
+    entry.script  = v8::Persistent<v8::Script>::New(script);
+    entry.extends = extends;
+
+    if(may_extend) {
+      *may_extend = entry.extends;
+    }
+
+    return script;
+  }
+
+  void TemplateCache::clear() {
+    std::unordered_map<std::string, ScriptEntry>::iterator it, end = _scripts.end();
+
+    for(it = _scripts.begin(); it != end; ++it) {
+      it->second.script.Dispose();
+    }
+
+    _scripts.clear();
+  }
+
+  void TemplateCache::clearSources() {
+    pthread_mutex_lock(&_sources_lock);
+    _sources.clear();
+    pthread_mutex_unlock(&_sources_lock);
+  }
+
+  TemplateCache::~TemplateCache() {
+    clear();
+  }
+
+}
+
+/* eof */
@@ -0,0 +1,121 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Template cache interface; caches translated and compiled templates
+ * \package template
+ *
+ * The template cache keeps the translated JavaScript source of template files
+ * (process wide) and the compiled, context independent scripts (per isolate),
+ * keyed by the file path and invalidated by device, inode, size and mtime
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TEMPLATE_CACHE_H
+#define TEMPLATE_CACHE_H
+
+#include <string>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <v8.h>
+
+#include "hash_map.hh"
+
+#include "jsevaluator/code_cache.hh"
+
+#include "template/template_exception.hh"
+
+namespace CForum {
+  class Template;
+
+  class TemplateCache {
+  public:
+    TemplateCache(bool = true);
+    ~TemplateCache();
+
+    v8::Local<v8::Script> getScript(const std::string &, Template *, bool * = NULL);
+
+    void setCheckMtime(bool);
+    bool getCheckMtime() const;
+
+    void clear();
+
+    static void clearSources();
+
+  private:
+    class FileStamp {
+    public:
+      FileStamp();
+
+      bool fromFile(const std::string &);
+      bool operator==(const FileStamp &) const;
+      bool operator!=(const FileStamp &) const;
+
+      dev_t device;
+      ino_t inode;
+      off_t size;
+      time_t mtime;
+    };
+
+    class SourceEntry {
+    public:
+      FileStamp stamp;
+      std::string source;
+      bool extends;
+    };
+
+    class ScriptEntry {
+    public:
+      FileStamp stamp;
+      v8::Persistent<v8::Script> script;
+      bool extends;
+    };
+
+    TemplateCache(const TemplateCache &);
+    TemplateCache &operator=(const TemplateCache &);
+
+    std::string getSource(const std::string &, const FileStamp &, Template *, bool *);
+
+    bool _check_mtime;
+    std::unordered_map<std::string, ScriptEntry> _scripts;
+
+    static std::unordered_map<std::string, SourceEntry> _sources;
+    static pthread_mutex_t _sources_lock;
+  };
+
+  inline void TemplateCache::setCheckMtime(bool check) {
+    _check_mtime = check;
+  }
+
+  inline bool TemplateCache::getCheckMtime() const {
+    return _check_mtime;
+  }
+
+}
+
+#endif
+
+/* eof */
@@ -40,6 +40,9 @@ namespace CForum {
     TemplateException(int);
     TemplateException(const char *, int);
     TemplateException(const std::string &, int);
+
+    static const int CompileError = 0x4fe6d3a8;
+    static const int ExtendError  = 0x4fe6d3a9;
   };
 }
 
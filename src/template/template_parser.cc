@@ -31,7 +31,29 @@
 #include "template/template.hh"
 
 namespace CForum {
-  std::string Template::parseFile(const std::string &filename) {
+  /*
+   * a template only gets buffered when its code calls extend() itself;
+   * obj.extend() or a name like my_extend is something else
+   */
+  static bool callsExtend(const std::string &code) {
+    size_t pos, end;
+
+    for(pos = code.find("extend"); pos != std::string::npos; pos = code.find("extend", pos + 1)) {
+      if(pos > 0 && (isalnum((unsigned char)code[pos - 1]) || code[pos - 1] == '_' || code[pos - 1] == '$' || code[pos - 1] == '.')) {
+        continue;
+      }
+
+      for(end = pos + 6; end < code.length() && isspace((unsigned char)code[end]); ++end) ;
+
+      if(end < code.length() && code[end] == '(') {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  std::string Template::parseFile(const std::string &filename, bool *calls_extend) {
     std::ifstream fd(filename.c_str(), std::ifstream::in);
     std::stringstream sst;
 
@@ -43,13 +65,15 @@ namespace CForum {
 
     fd.close();
 
-    return parseString(sst.str());
+    std::string source = sst.str();
+    return parseString(source.c_str(), source.length(), calls_extend);
   }
 
-  std::string Template::parseString(const char *str,size_t len) {
+  std::string Template::parseString(const char *str,size_t len,bool *calls_extend) {
     int mode = TemplateParseModeString;
     const char *ptr;
     std::string tmp,rslt;
+    bool extends = false;
     int i;
 
     for(ptr=str; static_cast<size_t>(ptr-str)<len; ++ptr) {
@@ -108,6 +132,7 @@ namespace CForum {
       else {
         if(*ptr == '%' && strncmp(ptr,"%>",2) == 0) {
           if(tmp.length() > 0) {
+            extends = extends || callsExtend(tmp);
             rslt += " ";
             rslt += tmp;
 
@@ -140,6 +165,7 @@ namespace CForum {
     }
     else {
       if(tmp.length() > 0) {
+        extends = extends || callsExtend(tmp);
         rslt += tmp;
 
         for(i=tmp.length();i>0;--i) {
@@ -151,6 +177,10 @@ namespace CForum {
       }
     }
 
+    if(calls_extend) {
+      *calls_extend = extends;
+    }
+
     return rslt;
   }
 }
@@ -0,0 +1,91 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Template pool implementation; reuses template contexts across requests
+ * \package template
+ *
+ * A template pool hands out pre-initialized templates (and thus V8 contexts)
+ * and takes them back when the request is done, so that we don't have to create
+ * a new context for every request
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "template/template_pool.hh"
+
+namespace CForum {
+  TemplatePool::Releaser::Releaser(boost::weak_ptr<TemplatePool> pool) : _pool(pool) { }
+
+  void TemplatePool::Releaser::operator()(Template *tpl) {
+    boost::shared_ptr<TemplatePool> pool = _pool.lock();
+
+    if(pool) {
+      pool->release(tpl);
+    }
+    else {
+      delete tpl;
+    }
+  }
+
+  TemplatePool::TemplatePool(v8::ExtensionConfiguration *ext, size_t max_idle, bool check_mtime) : _extensions(ext), _idle(), _max_idle(max_idle), _cache(check_mtime) { }
+
+  boost::shared_ptr<Template> TemplatePool::acquire() {
+    Template *tpl;
+
+    if(_idle.empty()) {
+      tpl = _extensions ? new Template(_extensions) : new Template();
+      tpl->setCache(&_cache);
+    }
+    else {
+      tpl = _idle.back();
+      _idle.pop_back();
+
+      tpl->enter();
+    }
+
+    tpl->reset();
+
+    return boost::shared_ptr<Template>(tpl, Releaser(shared_from_this()));
+  }
+
+  void TemplatePool::release(Template *tpl) {
+    tpl->leave();
+
+    if(_idle.size() >= _max_idle) {
+      delete tpl;
+      return;
+    }
+
+    _idle.push_back(tpl);
+  }
+
+  TemplatePool::~TemplatePool() {
+    std::vector<Template *>::iterator it, end = _idle.end();
+
+    for(it = _idle.begin(); it != end; ++it) {
+      delete *it;
+    }
+  }
+
+}
+
+/* eof */
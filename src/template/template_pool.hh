@@ -0,0 +1,92 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Template pool interface; reuses template contexts across requests
+ * \package template
+ *
+ * A template pool hands out pre-initialized templates (and thus V8 contexts)
+ * and takes them back when the request is done, so that we don't have to create
+ * a new context for every request
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TEMPLATE_POOL_H
+#define TEMPLATE_POOL_H
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+
+#include <v8.h>
+
+#include "template/template.hh"
+#include "template/template_cache.hh"
+
+namespace CForum {
+  class TemplatePool : public boost::enable_shared_from_this<TemplatePool> {
+  public:
+    TemplatePool(v8::ExtensionConfiguration * = NULL, size_t = 4, bool = true);
+    ~TemplatePool();
+
+    boost::shared_ptr<Template> acquire();
+    void release(Template *);
+
+    size_t getIdleCount() const;
+    TemplateCache &getCache();
+
+  private:
+    class Releaser {
+    public:
+      Releaser(boost::weak_ptr<TemplatePool>);
+      void operator()(Template *);
+
+    private:
+      boost::weak_ptr<TemplatePool> _pool;
+    };
+
+    TemplatePool(const TemplatePool &);
+    TemplatePool &operator=(const TemplatePool &);
+
+    v8::ExtensionConfiguration *_extensions;
+    std::vector<Template *> _idle;
+    size_t _max_idle;
+
+    TemplateCache _cache;
+  };
+
+  inline size_t TemplatePool::getIdleCount() const {
+    return _idle.size();
+  }
+
+  inline TemplateCache &TemplatePool::getCache() {
+    return _cache;
+  }
+
+}
+
+#endif
+
+/* eof */
@@ -0,0 +1,163 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Benchmark for the URL decoding and encoding kernels
+ *
+ * Compares CGI::decode and CGI::encode with the byte-at-a-time versions
+ * they replaced
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "cgi/cgi.hh"
+
+/* the implementations before the vectorised kernels, kept for comparison */
+static UnicodeString legacyDecode(const char *str, size_t len) {
+  std::string ustr;
+  const char *ptr;
+  char ptr3[3] = { '\0','\0','\0' };
+
+  for(ptr=str;(size_t)(ptr-str) < len;++ptr) {
+    switch(*ptr) {
+      case '+':
+        ustr += ' ';
+        break;
+
+      case '%':
+        if((size_t)(ptr+2 - str) >= len) {
+          ustr += '%';
+          if((size_t)(ptr+1 - str) < len) {
+            ustr += *(ptr+1);
+          }
+
+          return UnicodeString(ustr.c_str(),"UTF-8");
+        }
+
+        memcpy(ptr3,ptr+1,2);
+        ustr += (char)strtol(ptr3,NULL,16);
+        ptr += 2;
+        break;
+
+      default:
+        ustr += *ptr;
+    }
+  }
+
+  return UnicodeString(ustr.c_str(),"UTF-8");
+}
+
+static std::string legacyEncode(const char *str) {
+  std::string ret;
+  const char *ptr;
+  char buff[10];
+
+  for(ptr=str;*ptr;++ptr) {
+    if((*ptr >= 48 && *ptr <= 122) || (*ptr == '_' || *ptr == '.' || *ptr == '-')) {
+      ret += *ptr;
+    }
+    else {
+      if(*ptr == ' ') {
+        ret += '+';
+      }
+      else {
+        snprintf(buff,10,"%%%02X",(int)*ptr);
+        ret += buff;
+      }
+    }
+  }
+
+  return ret;
+}
+
+static double now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void report(const char *name, double secs, size_t bytes) {
+  printf("%-28s %8.1f MB/s\n", name, bytes / secs / (1024 * 1024));
+}
+
+int main(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 2000, i;
+  std::string text, encoded, out;
+  volatile size_t sink = 0;
+  double start;
+
+  /* something resembling a message body: mostly ASCII, a few umlauts, punctuation */
+  while(text.length() < 16384) {
+    text += "Hallo Welt, das ist ein etwas längerer Beitrag mit Umlauten (äöü) und Satzzeichen! ";
+  }
+
+  encoded = CForum::CGI::encode(text);
+
+  start = now();
+  for(i = 0; i < rounds; ++i) {
+    sink += legacyDecode(encoded.data(), encoded.length()).length();
+  }
+  report("decode (legacy)", now() - start, encoded.length() * rounds);
+
+  start = now();
+  for(i = 0; i < rounds; ++i) {
+    sink += CForum::CGI::decode(encoded.data(), encoded.length()).length();
+  }
+  report("decode", now() - start, encoded.length() * rounds);
+
+  start = now();
+  for(i = 0; i < rounds; ++i) {
+    out.clear();
+    CForum::CGI::decodeUTF8(encoded.data(), encoded.length(), out);
+    sink += out.length();
+  }
+  report("decodeUTF8", now() - start, encoded.length() * rounds);
+
+  start = now();
+  for(i = 0; i < rounds; ++i) {
+    sink += legacyEncode(text.c_str()).length();
+  }
+  report("encode (legacy)", now() - start, text.length() * rounds);
+
+  start = now();
+  for(i = 0; i < rounds; ++i) {
+    sink += CForum::CGI::encode(text.c_str()).length();
+  }
+  report("encode", now() - start, text.length() * rounds);
+
+  out.clear();
+  CForum::CGI::decodeUTF8(encoded.data(), encoded.length(), out);
+  if(out != text) {
+    fprintf(stderr, "decodeUTF8(encode(text)) does not give back the text!\n");
+    return 1;
+  }
+
+  return sink == 0;
+}
+
+/* eof */
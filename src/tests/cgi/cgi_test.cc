@@ -71,6 +71,10 @@ void CGITest::testParser() {
   val.toUTF8String(str);
   CPPUNIT_ASSERT_EQUAL(std::string("b2"),str);
 
+  CPPUNIT_ASSERT_EQUAL(std::string("äöü"), c.getFirstUTF8Value("äöü", "G"));
+  CPPUNIT_ASSERT_EQUAL(std::string("b"), c.getFirstUTF8Value("a"));
+  CPPUNIT_ASSERT(!c.getValue("does-not-exist","G"));
+
 
   p = c.getValue("test-cookie","C");
   CPPUNIT_ASSERT(p != NULL);
@@ -96,6 +100,99 @@ void CGITest::testParser() {
 
 }
 
+void CGITest::testCodec() {
+  std::string str, longer = "a fairly long value with more than sixteen bytes";
+
+  CForum::CGI::decodeUTF8("%C3%A4+b%2fc%2", 14, str);
+  CPPUNIT_ASSERT_EQUAL(std::string("ä b/c%2"), str);
+
+  /* broken escapes stay as they are */
+  str = "";
+  CForum::CGI::decodeUTF8("100%zz", 6, str);
+  CPPUNIT_ASSERT_EQUAL(std::string("100%zz"), str);
+
+  CPPUNIT_ASSERT_EQUAL(std::string("%C3%A4+b%2Fc"), CForum::CGI::encode("ä b/c"));
+
+  str = "";
+  CForum::CGI::decodeUTF8(CForum::CGI::encode(longer).c_str(), CForum::CGI::encode(longer).length(), str);
+  CPPUNIT_ASSERT_EQUAL(longer, str);
+}
+void CGITest::testMultipart() {
+  std::string body = "--XyZ\r\nContent-Disposition: form-data; name=\"subject\"\r\n\r\nHallo\r\n--Welt\r\n"
+    "--XyZ\r\nContent-Disposition: form-data; name=\"file\"; filename=\"a.txt\"\r\nContent-Type: text/plain\r\n\r\n"
+    "file contents\r\n--XyZ--\r\n";
+  CForum::CGI c;
+  CForum::BodyParser parser(c, "multipart/form-data; boundary=XyZ");
+  size_t i;
+
+  /* byte by byte, so every delimiter is split at some point */
+  for(i = 0; i < body.length(); ++i) {
+    parser.feed(body.data() + i, 1);
+  }
+
+  parser.finish();
+
+  CPPUNIT_ASSERT_EQUAL(std::string("Hallo\r\n--Welt"), c.getFirstUTF8Value("subject", "P"));
+  CPPUNIT_ASSERT_EQUAL(std::string("a.txt"), c.getFirstUTF8Value("file", "P"));
+
+  boost::shared_ptr<CForum::Upload> upload = c.getUpload("file");
+  CPPUNIT_ASSERT(upload);
+  CPPUNIT_ASSERT_EQUAL(std::string("text/plain"), upload->getContentType());
+  CPPUNIT_ASSERT_EQUAL(std::string("file contents"), upload->getContents());
+}
+
+void CGITest::testParameterLimit() {
+  std::string query;
+  CForum::CGI c;
+  size_t i;
+
+  for(i = 0; i < CForum::CGI::MaxParameters; ++i) {
+    query += "a=1&";
+  }
+
+  c.parseString(query, 'G');
+  CPPUNIT_ASSERT_EQUAL((size_t)CForum::CGI::MaxParameters, c.getValue("a", "G")->size());
+
+  CPPUNIT_ASSERT_THROW(c.parseString("b=2", 'G'), CForum::CGIParserException);
+}
+void CGITest::testHeaderLookup() {
+  CForum::CGI c;
+  const std::string *inm;
+  char name[32];
+  int i;
+
+  c.parseHeaderFromCGI("HTTP_IF_NONE_MATCH=W/\"x\"");
+  inm = &c.getHeader("If-None-Match");
+
+  /* misses must neither insert nor move what has been handed out already */
+  for(i = 0; i < 64; ++i) {
+    snprintf(name, sizeof(name), "X-Missing-%d", i);
+    CPPUNIT_ASSERT(c.getHeader(name).empty());
+  }
+
+  CPPUNIT_ASSERT(inm == &c.getHeader("If-None-Match"));
+  CPPUNIT_ASSERT_EQUAL(std::string("W/\"x\""), *inm);
+  CPPUNIT_ASSERT(c.getCGIVariable("HTTPS").empty());
+}
+
+void CGITest::testLongField() {
+  std::string body;
+  CForum::CGI c;
+  size_t i;
+
+  for(i = 0; i < 1000; ++i) {
+    body += "a&";
+  }
+
+  /* fields without a = must not be searched past their end */
+  body += std::string(8 * 1024 * 1024, 'x');
+  body += "&b=1";
 
+  c.parseString(body, 'P');
+
+  CPPUNIT_ASSERT_EQUAL((size_t)1000, c.getValue("a", "P")->size());
+  CPPUNIT_ASSERT(c.getFirstValue("a", "P").isEmpty());
+  CPPUNIT_ASSERT(c.getFirstValue("b", "P") == UnicodeString("1"));
+}
 
 /* eof */
@@ -33,16 +33,28 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <cstdlib>
+#include <cstdio>
 
 #include "cgi/cgi.hh"
+#include "cgi/body_parser.hh"
 
 class CGITest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(CGITest);
   CPPUNIT_TEST(testParser);
+  CPPUNIT_TEST(testCodec);
+  CPPUNIT_TEST(testMultipart);
+  CPPUNIT_TEST(testParameterLimit);
+  CPPUNIT_TEST(testHeaderLookup);
+  CPPUNIT_TEST(testLongField);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testParser();
+  void testCodec();
+  void testMultipart();
+  void testParameterLimit();
+  void testHeaderLookup();
+  void testLongField();
 };
 
 #endif
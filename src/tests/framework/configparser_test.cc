@@ -76,4 +76,44 @@ void ConfigParserTest::testGetByPath() {
   CPPUNIT_ASSERT_EQUAL(std::string(*sval1), std::string("Ano"));*/
 }
 
+void ConfigParserTest::testSnapshot() {
+  CForum::JSEvaluator evaluator;
+  CForum::ConfigValue val = CForum::ConfigValue::fromV8(evaluator.evaluateString("({ano: {xyz: 'zyx', nymous: ['Ano', 3], flag: false}})"));
+
+  CPPUNIT_ASSERT(val.isObject());
+  CPPUNIT_ASSERT_EQUAL(std::string("zyx"), val.getByPath("/ano/xyz")->asString());
+  CPPUNIT_ASSERT_EQUAL(std::string("Ano"), val.getByPath("ano/nymous/0")->asString());
+  CPPUNIT_ASSERT_EQUAL(3L, val.getByPath("ano/nymous/1")->asInt());
+  CPPUNIT_ASSERT(val.getByPath("ano/flag")->isBool());
+  CPPUNIT_ASSERT(!val.getByPath("ano/flag")->asBool());
+  CPPUNIT_ASSERT(val.getByPath("ano/nymous/2") == NULL);
+  CPPUNIT_ASSERT(val.getByPath("ano/xyz/foo") == NULL);
+
+  CForum::ConfigValue same = CForum::ConfigValue::fromV8(evaluator.evaluateString("({ano: {xyz: 'zyx', nymous: ['Ano', 3], flag: false}})"));
+  CForum::ConfigValue other = CForum::ConfigValue::fromV8(evaluator.evaluateString("({ano: {xyz: 'zyx', nymous: ['Ano', 4], flag: false}})"));
+
+  CPPUNIT_ASSERT(val == same);
+  CPPUNIT_ASSERT(val != other);
+  CPPUNIT_ASSERT(*val.getByPath("ano/xyz") == *other.getByPath("ano/xyz"));
+  CPPUNIT_ASSERT(val.getByPath("ano/nymous/1x") == NULL);
+}
+
+void ConfigParserTest::testValueCache() {
+  CForum::JSEvaluator evaluator;
+  v8::HandleScope scope;
+  CForum::ConfigValueCache cache;
+  boost::shared_ptr<const CForum::ConfigValue> snapshot = boost::make_shared<CForum::ConfigValue>(CForum::ConfigValue::fromV8(evaluator.evaluateString("({ano: {xyz: 'zyx', nymous: ['Ano', 3]}})")));
+
+  v8::Local<v8::Value> first = cache.get(snapshot, *snapshot->getByPath("ano/xyz"));
+  v8::Local<v8::Value> second = cache.get(snapshot, *snapshot->getByPath("ano/xyz"));
+
+  /* the second read hands out the string of the first one */
+  CPPUNIT_ASSERT(first->StrictEquals(second));
+  CPPUNIT_ASSERT_EQUAL(std::string("zyx"), std::string(*v8::String::Utf8Value(second)));
+
+  v8::Local<v8::Value> ary = cache.get(snapshot, *snapshot->getByPath("ano/nymous"));
+  CPPUNIT_ASSERT(ary->IsArray());
+  CPPUNIT_ASSERT_EQUAL(3.0, v8::Local<v8::Array>::Cast(ary)->Get(1)->NumberValue());
+}
+
 /* eof */
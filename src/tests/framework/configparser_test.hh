@@ -36,6 +36,8 @@
 #include <cstdlib>
 
 #include "framework/configparser.hh"
+#include "framework/config_value.hh"
+#include "jsevaluator/js_evaluator.hh"
 
 class ConfigParserTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ConfigParserTest);
@@ -43,6 +45,8 @@ class ConfigParserTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testGetObject);
   CPPUNIT_TEST(testGetString);
   CPPUNIT_TEST(testGetByPath);
+  CPPUNIT_TEST(testSnapshot);
+  CPPUNIT_TEST(testValueCache);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -51,6 +55,8 @@ public:
   void testGetObject();
   void testGetString();
   void testGetByPath();
+  void testSnapshot();
+  void testValueCache();
 
 private:
   CForum::Configparser configParser;
@@ -0,0 +1,95 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP connection testing
+ * \package unittests
+ *
+ * HTTP connection testing
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "http_connection_test.hh"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HTTPConnectionTest);
+
+using namespace CForum;
+
+/* feeds the request through a socket pair, like a client would */
+HTTPConnection::ParseResult HTTPConnectionTest::parse(const char *request, HTTPConnection::Message &msg, int *status) {
+  HTTPConnection::ParseResult rslt;
+  int sv[2];
+
+  CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+  fcntl(sv[0], F_SETFL, O_NONBLOCK);
+
+  HTTPConnection conn(sv[0], "127.0.0.1");
+  conn.setLimits(1024, 1024);
+
+  CPPUNIT_ASSERT_EQUAL((ssize_t)strlen(request), write(sv[1], request, strlen(request)));
+
+  conn.readInput();
+  rslt = conn.parseRequest(msg, status);
+
+  close(sv[1]);
+  return rslt;
+}
+
+void HTTPConnectionTest::testRequest() {
+  HTTPConnection::Message msg;
+  int status = 0;
+
+  CPPUNIT_ASSERT_EQUAL(HTTPConnection::ParseComplete, parse("POST /t/1 HTTP/1.1\r\nHost: localhost\r\nContent-Length: 3\r\n\r\nabc", msg, &status));
+  CPPUNIT_ASSERT_EQUAL(std::string("POST"), msg.method);
+  CPPUNIT_ASSERT_EQUAL(std::string("/t/1"), msg.target);
+  CPPUNIT_ASSERT_EQUAL(std::string("abc"), msg.body);
+  CPPUNIT_ASSERT(msg.keepAlive);
+}
+
+void HTTPConnectionTest::testContentLength() {
+  HTTPConnection::Message msg;
+  int status = 0;
+
+  CPPUNIT_ASSERT_EQUAL(HTTPConnection::ParseError, parse("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\nabc", msg, &status));
+  CPPUNIT_ASSERT_EQUAL(400, status);
+
+  CPPUNIT_ASSERT_EQUAL(HTTPConnection::ParseError, parse("POST / HTTP/1.1\r\nContent-Length: +3\r\n\r\nabc", msg, &status));
+  CPPUNIT_ASSERT_EQUAL(400, status);
+
+  CPPUNIT_ASSERT_EQUAL(HTTPConnection::ParseError, parse("POST / HTTP/1.1\r\nContent-Length: 3000\r\n\r\nabc", msg, &status));
+  CPPUNIT_ASSERT_EQUAL(413, status);
+}
+
+void HTTPConnectionTest::testHeaderName() {
+  HTTPConnection::Message msg;
+  int status = 0;
+
+  /* whitespace before the colon: a lenient proxy may frame by it, we must not ignore it */
+  CPPUNIT_ASSERT_EQUAL(HTTPConnection::ParseError, parse("POST / HTTP/1.1\r\nContent-Length : 5\r\n\r\nGET /x HTTP/1.1\r\n\r\n", msg, &status));
+  CPPUNIT_ASSERT_EQUAL(400, status);
+
+  status = 0;
+  CPPUNIT_ASSERT_EQUAL(HTTPConnection::ParseError, parse("GET / HTTP/1.1\r\nHost\t: localhost\r\n\r\n", msg, &status));
+  CPPUNIT_ASSERT_EQUAL(400, status);
+}
+
+/* eof */
@@ -0,0 +1,62 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief HTTP connection testing
+ * \package unittests
+ *
+ * HTTP connection testing
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HTTP_CONNECTION_TEST_H
+#define HTTP_CONNECTION_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cstring>
+
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "framework/http_connection.hh"
+
+class HTTPConnectionTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HTTPConnectionTest);
+  CPPUNIT_TEST(testRequest);
+  CPPUNIT_TEST(testContentLength);
+  CPPUNIT_TEST(testHeaderName);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testRequest();
+  void testContentLength();
+  void testHeaderName();
+
+private:
+  CForum::HTTPConnection::ParseResult parse(const char *, CForum::HTTPConnection::Message &, int *);
+};
+
+#endif
+
+/* eof */
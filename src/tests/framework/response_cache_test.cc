@@ -0,0 +1,90 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief Response cache testing
+ * \package unittests
+ *
+ * Response cache testing
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "response_cache_test.hh"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponseCacheTest);
+
+using namespace CForum;
+
+void ResponseCacheTest::setUp() {
+  setenv("REQUEST_METHOD", "GET", 1);
+  setenv("QUERY_STRING", "", 1);
+  setenv("PATH_INFO", "/2011/jan/01/slug", 1);
+  setenv("SERVER_NAME", "localhost", 1);
+  setenv("SERVER_PROTOCOL", "http", 1);
+  setenv("SERVER_PORT", "80", 1);
+}
+
+void ResponseCacheTest::testStore() {
+  ResponseCache cache;
+  boost::shared_ptr<CGIRequest> request(boost::make_shared<CGIRequest>());
+  std::string key;
+
+  CPPUNIT_ASSERT(cache.keyFor(request).empty());
+
+  cache.setLimit(4096);
+  key = cache.keyFor(request);
+  CPPUNIT_ASSERT(!key.empty());
+
+  cache.store(key, request, "<p>thread</p>", 1, cache.getEpoch());
+  CPPUNIT_ASSERT(cache.lookup(key, 1));
+  CPPUNIT_ASSERT_EQUAL(std::string("<p>thread</p>"), cache.lookup(key, 1)->body);
+
+  /* rendered with another config */
+  CPPUNIT_ASSERT(!cache.lookup(key, 2));
+}
+
+void ResponseCacheTest::testNotification() {
+  boost::shared_ptr<ResponseCache> cache(boost::make_shared<ResponseCache>());
+  boost::shared_ptr<CGIRequest> request(boost::make_shared<CGIRequest>());
+  NotificationCenter ncenter;
+  unsigned long epoch;
+  std::string key;
+
+  cache->setLimit(4096);
+  key   = cache->keyFor(request);
+  epoch = cache->getEpoch();
+
+  cache->store(key, request, "<p>thread</p>", 1, epoch);
+  CPPUNIT_ASSERT(cache->lookup(key, 1));
+
+  ncenter.registerNotification("notify: thread changed", cache);
+  ncenter.notify("notify: thread changed", request, NULL);
+
+  CPPUNIT_ASSERT_EQUAL(epoch + 1, cache->getEpoch());
+  CPPUNIT_ASSERT(!cache->lookup(key, 1));
+
+  /* a page rendered before the change must not come back */
+  cache->store(key, request, "<p>stale</p>", 1, epoch);
+  CPPUNIT_ASSERT(!cache->lookup(key, 1));
+}
+
+/* eof */
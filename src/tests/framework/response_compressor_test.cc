@@ -0,0 +1,85 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief response compressor testing
+ * \package unittests
+ *
+ * response compressor testing
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "response_compressor_test.hh"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponseCompressorTest);
+
+void ResponseCompressorTest::testNegotiate() {
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingGzip, CForum::ResponseCompressor::negotiate("gzip, deflate"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingDeflate, CForum::ResponseCompressor::negotiate("gzip;q=0, deflate"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingGzip, CForum::ResponseCompressor::negotiate(" GZIP ;q=0.5"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingIdentity, CForum::ResponseCompressor::negotiate("identity"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingIdentity, CForum::ResponseCompressor::negotiate(""));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingDeflate, CForum::ResponseCompressor::negotiate("gzip;q=0, *"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingIdentity, CForum::ResponseCompressor::negotiate("gzip;q=0, deflate;q=0, *"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingDeflate, CForum::ResponseCompressor::negotiate("gzip;Q=0, deflate"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingIdentity, CForum::ResponseCompressor::negotiate("gzip; Q = 0.000"));
+  CPPUNIT_ASSERT_EQUAL(CForum::ResponseCompressor::EncodingGzip, CForum::ResponseCompressor::negotiate("*"));
+}
+
+void ResponseCompressorTest::testRoundtrip() {
+  CForum::ResponseCompressor comp(CForum::ResponseCompressor::EncodingGzip, 6);
+  std::string html, packed, unpacked;
+  char buff[4096];
+  z_stream strm;
+  int i, rc;
+
+  for(i = 0; i < 200; ++i) {
+    html += "<li class=\"thread\"><a href=\"/t/1234\">Re: a subject</a></li>\n";
+  }
+
+  /* two chunks like a streamed response */
+  comp.compress(html.data(), html.length() / 2, false, packed);
+  comp.compress(html.data() + html.length() / 2, html.length() - html.length() / 2, false, packed);
+  comp.compress(NULL, 0, true, packed);
+
+  CPPUNIT_ASSERT(comp.isFinished());
+  CPPUNIT_ASSERT(packed.length() < html.length() / 10);
+
+  memset(&strm, 0, sizeof(strm));
+  inflateInit2(&strm, 15 + 16);
+  strm.next_in  = reinterpret_cast<Bytef *>(const_cast<char *>(packed.data()));
+  strm.avail_in = (uInt)packed.length();
+
+  do {
+    strm.next_out  = reinterpret_cast<Bytef *>(buff);
+    strm.avail_out = sizeof(buff);
+    rc = inflate(&strm, Z_NO_FLUSH);
+    unpacked.append(buff, sizeof(buff) - strm.avail_out);
+  } while(rc == Z_OK);
+
+  inflateEnd(&strm);
+
+  CPPUNIT_ASSERT_EQUAL(Z_STREAM_END, rc);
+  CPPUNIT_ASSERT_EQUAL(html, unpacked);
+}
+
+/* eof */
@@ -115,4 +115,63 @@ void RouteTest::testParserFail() {
   CPPUNIT_ASSERT_EQUAL((size_t)0, r.getPatterns().size());
 }
 
+void RouteTest::testTypedCaptures() {
+  boost::shared_ptr<MyController> c(new MyController());
+  Route r(c);
+
+  r.addPattern("^/<tid:slug>/<mid:int>/<action:int\\w+>$");
+
+  const Route::Pattern &pat = r.getPatterns()[0];
+
+  CPPUNIT_ASSERT_EQUAL(std::string("^/([A-Za-z0-9]+(?:-[A-Za-z0-9]+)*)/([0-9]{1,18})/(int\\w+)$"), pat.getPattern());
+  CPPUNIT_ASSERT_EQUAL(Route::CaptureTypeSlug, pat.getType(0));
+  CPPUNIT_ASSERT_EQUAL(Route::CaptureTypeInt, pat.getType(1));
+  CPPUNIT_ASSERT_EQUAL(Route::CaptureTypeText, pat.getType(2));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pat.indexOf("mid"));
+}
+
+void RouteTest::testBind() {
+  boost::shared_ptr<MyController> c(new MyController());
+  Route r(c);
+  std::string path("/my-thread/42");
+  int ovector[3 * (Route::MaxCaptures + 1)], rc;
+  RouteVars vars;
+
+  r.addPattern("^/<tid:slug>/<mid:int>$");
+
+  const Route::Pattern &pat = r.getPatterns()[0];
+
+  rc = pat.getCompiledPattern()->match(path.data(), path.length(), ovector, 3 * (Route::MaxCaptures + 1));
+  CPPUNIT_ASSERT_EQUAL(3, rc);
+  CPPUNIT_ASSERT(vars.bind(&path, pat, ovector, rc));
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, vars.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("my-thread"), vars.get(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("42"), vars.get("mid"));
+  CPPUNIT_ASSERT_EQUAL(42LL, vars.getInt(1));
+  CPPUNIT_ASSERT_EQUAL(0LL, vars.getInt(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("my-thread"), vars.getMap().find("tid")->second);
+  CPPUNIT_ASSERT_EQUAL(RouteVars::NoVariable, vars.indexOf("nope"));
+
+  /* only digits fit an int capture */
+  path = "/my-thread/4x2";
+  CPPUNIT_ASSERT(pat.getCompiledPattern()->match(path.data(), path.length(), ovector, 3 * (Route::MaxCaptures + 1)) < 0);
+}
+
+void RouteTest::testBindMissingInt() {
+  boost::shared_ptr<MyController> c(new MyController());
+  Route r(c);
+  std::string path("/thread/");
+  int ovector[3 * (Route::MaxCaptures + 1)], rc;
+  RouteVars vars;
+
+  r.addPattern("^/thread/<mid:int>?$");
+
+  const Route::Pattern &pat = r.getPatterns()[0];
+
+  rc = pat.getCompiledPattern()->match(path.data(), path.length(), ovector, 3 * (Route::MaxCaptures + 1));
+  CPPUNIT_ASSERT(rc > 0);
+  CPPUNIT_ASSERT(!vars.bind(&path, pat, ovector, rc));
+}
+
 /* eof */
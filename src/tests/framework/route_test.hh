@@ -34,6 +34,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "framework/route.hh"
+#include "framework/route_vars.hh"
 #include "my_controller.hh"
 
 class RouteTest : public CppUnit::TestFixture {
@@ -41,12 +42,18 @@ class RouteTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testEmpty);
   CPPUNIT_TEST(testParser);
   CPPUNIT_TEST(testParserFail);
+  CPPUNIT_TEST(testTypedCaptures);
+  CPPUNIT_TEST(testBind);
+  CPPUNIT_TEST(testBindMissingInt);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testEmpty();
   void testParser();
   void testParserFail();
+  void testTypedCaptures();
+  void testBind();
+  void testBindMissingInt();
 };
 
 #endif
@@ -53,6 +53,13 @@ public:
 };
 
 
+class CacheRouter : public Router {
+public:
+  size_t cached() {
+    return cache.size();
+  }
+};
+
 
 void RouterTest::setUp() {
   setenv("REQUEST_METHOD", "GET", 1);
@@ -154,6 +161,96 @@ void RouterTest::testEmpty() {
   }
 }
 
+void RouterTest::testLeadingText() {
+  bool anchored;
+
+  CPPUNIT_ASSERT_EQUAL(std::string("/just/a/"), CompiledPattern::leadingText("^/just/a/(test)$", anchored));
+  CPPUNIT_ASSERT(anchored);
+  CPPUNIT_ASSERT_EQUAL(std::string("/a.b"), CompiledPattern::leadingText("^/a\\.b\\d+$", anchored));
+  CPPUNIT_ASSERT_EQUAL(std::string("/a"), CompiledPattern::leadingText("^/ab?$", anchored));
+  CPPUNIT_ASSERT_EQUAL(std::string(""), CompiledPattern::leadingText("^/?$", anchored));
+  CPPUNIT_ASSERT_EQUAL(std::string("/just/a"), CompiledPattern::leadingText("/just/a", anchored));
+  CPPUNIT_ASSERT(!anchored);
+  CPPUNIT_ASSERT_EQUAL(std::string(""), CompiledPattern::leadingText("^/just|/a", anchored));
+}
+
+void RouterTest::testTypedNoMatch() {
+  boost::shared_ptr<MyController> c(new MyController());
+  boost::shared_ptr<Route> route(boost::make_shared<Route>(c));
+  Router router;
+  boost::shared_ptr<CGIRequest> request(boost::make_shared<CGIRequest>());
+
+  route->addPattern("^/just/a/<id:int>$");
+
+  router.registerRoute("test-route", route);
+
+  try {
+    router.dispatch(request);
+    CPPUNIT_FAIL("Fail: int capture matched a word");
+  }
+  catch(NotFoundException &e) {
+  }
+}
+
+void RouterTest::testCache() {
+  boost::shared_ptr<MyController> c(new MyController());
+  boost::shared_ptr<Route> route(boost::make_shared<Route>(c)), other(boost::make_shared<Route>(c));
+  CacheRouter router;
+
+  route->addPattern("^/just/a/<action:test>$");
+  router.registerRoute("test-route", route);
+
+  CPPUNIT_ASSERT_EQUAL(std::string("MyController::handleRequest"), router.dispatch(boost::make_shared<CGIRequest>()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, router.cached());
+
+  /* the second dispatch is answered from the cache */
+  CPPUNIT_ASSERT_EQUAL(std::string("MyController::handleRequest"), router.dispatch(boost::make_shared<CGIRequest>()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, router.cached());
+
+  /* a new route has to flush what we remembered */
+  other->addPattern("^/just/");
+  router.registerRoute("other-route", other);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, router.cached());
+  CPPUNIT_ASSERT_EQUAL(std::string("MyController::handleRequestMyController::handleRequest"), router.dispatch(boost::make_shared<CGIRequest>()));
+
+  /* paths nobody handles stay out */
+  setenv("PATH_INFO", "/nowhere", 1);
+
+  try {
+    router.dispatch(boost::make_shared<CGIRequest>());
+    CPPUNIT_FAIL("Fail: route matched but shouldn't");
+  }
+  catch(NotFoundException &e) {
+  }
+
+  CPPUNIT_ASSERT_EQUAL((size_t)1, router.cached());
+}
+
+void RouterTest::testCacheLimit() {
+  boost::shared_ptr<MyController> c(new MyController());
+  boost::shared_ptr<Route> route(boost::make_shared<Route>(c));
+  CacheRouter router;
+
+  route->addPattern("^/just/<action:\\w+>/test$");
+  router.registerRoute("test-route", route);
+  router.setCacheLimit(2);
+
+  setenv("PATH_INFO", "/just/a/test", 1);
+  router.dispatch(boost::make_shared<CGIRequest>());
+  setenv("PATH_INFO", "/just/b/test", 1);
+  router.dispatch(boost::make_shared<CGIRequest>());
+  setenv("PATH_INFO", "/just/c/test", 1);
+  router.dispatch(boost::make_shared<CGIRequest>());
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, router.cached());
+
+  router.setCacheLimit(0);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, router.cached());
+
+  CPPUNIT_ASSERT_EQUAL(std::string("MyController::handleRequest"), router.dispatch(boost::make_shared<CGIRequest>()));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, router.cached());
+}
+
 void RouterTest::tearDown() {
   unsetenv("REQUEST_METHOD");
   unsetenv("QUERY_STRING");
@@ -47,6 +47,10 @@ class RouterTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAclTrue);
   CPPUNIT_TEST(testAclFalse);
   CPPUNIT_TEST(testEmpty);
+  CPPUNIT_TEST(testLeadingText);
+  CPPUNIT_TEST(testTypedNoMatch);
+  CPPUNIT_TEST(testCache);
+  CPPUNIT_TEST(testCacheLimit);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -56,6 +60,10 @@ public:
   void testAclTrue();
   void testAclFalse();
   void testEmpty();
+  void testLeadingText();
+  void testTypedNoMatch();
+  void testCache();
+  void testCacheLimit();
   void tearDown();
 };
 
@@ -34,46 +34,71 @@ CPPUNIT_TEST_SUITE_REGISTRATION(URITest);
 
 void URITest::testParser() {
   CForum::URI uri("http://wwwtech.de");
-  CPPUNIT_ASSERT_EQUAL(std::string("http"), uri.getScheme());
+  CPPUNIT_ASSERT_EQUAL(std::string("http"), uri.getScheme().str());
   CPPUNIT_ASSERT_EQUAL(80, uri.getPort());
-  CPPUNIT_ASSERT_EQUAL(std::string("/"), uri.getPath());
-  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri.getHost());
-  CPPUNIT_ASSERT_EQUAL(std::string(""), uri.getFragment());
-  CPPUNIT_ASSERT_EQUAL(std::string(""), uri.getQueryString());
-  CPPUNIT_ASSERT_EQUAL(std::string("html"), uri.getMedia());
+  CPPUNIT_ASSERT_EQUAL(std::string("/"), uri.getPath().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri.getHost().str());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), uri.getFragment().str());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), uri.getQueryString().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("html"), uri.getMedia().str());
   CPPUNIT_ASSERT_EQUAL(std::string("http://wwwtech.de/"), uri.toString());
 
   CForum::URI uri1("https://wwwtech.de:8080#lala");
-  CPPUNIT_ASSERT_EQUAL(std::string("https"), uri1.getScheme());
+  CPPUNIT_ASSERT_EQUAL(std::string("https"), uri1.getScheme().str());
   CPPUNIT_ASSERT_EQUAL(8080, uri1.getPort());
-  CPPUNIT_ASSERT_EQUAL(std::string("/"), uri1.getPath());
-  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri1.getHost());
-  CPPUNIT_ASSERT_EQUAL(std::string("#lala"), uri1.getFragment());
-  CPPUNIT_ASSERT_EQUAL(std::string(""), uri1.getQueryString());
-  CPPUNIT_ASSERT_EQUAL(std::string("html"), uri1.getMedia());
+  CPPUNIT_ASSERT_EQUAL(std::string("/"), uri1.getPath().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri1.getHost().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("#lala"), uri1.getFragment().str());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), uri1.getQueryString().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("html"), uri1.getMedia().str());
   CPPUNIT_ASSERT_EQUAL(std::string("https://wwwtech.de:8080/#lala"), uri1.toString());
 
   CForum::URI uri2("https://wwwtech.de:8080/lala/lulu#lala");
-  CPPUNIT_ASSERT_EQUAL(std::string("https"), uri2.getScheme());
+  CPPUNIT_ASSERT_EQUAL(std::string("https"), uri2.getScheme().str());
   CPPUNIT_ASSERT_EQUAL(8080, uri2.getPort());
-  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu"), uri2.getPath());
-  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri2.getHost());
-  CPPUNIT_ASSERT_EQUAL(std::string("#lala"), uri2.getFragment());
-  CPPUNIT_ASSERT_EQUAL(std::string(""), uri2.getQueryString());
-  CPPUNIT_ASSERT_EQUAL(std::string("html"), uri2.getMedia());
+  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu"), uri2.getPath().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri2.getHost().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("#lala"), uri2.getFragment().str());
+  CPPUNIT_ASSERT_EQUAL(std::string(""), uri2.getQueryString().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("html"), uri2.getMedia().str());
   CPPUNIT_ASSERT_EQUAL(std::string("https://wwwtech.de:8080/lala/lulu#lala"), uri2.toString());
 
   CForum::URI uri3("https://wwwtech.de:8080/lala/lulu.php?abc=def#lala");
-  CPPUNIT_ASSERT_EQUAL(std::string("https"), uri3.getScheme());
+  CPPUNIT_ASSERT_EQUAL(std::string("https"), uri3.getScheme().str());
   CPPUNIT_ASSERT_EQUAL(8080, uri3.getPort());
-  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu.php"), uri3.getPath());
-  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu"), uri3.getPathWoSuffix());
-  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri3.getHost());
-  CPPUNIT_ASSERT_EQUAL(std::string("#lala"), uri3.getFragment());
-  CPPUNIT_ASSERT_EQUAL(std::string("abc=def"), uri3.getQueryString());
-  CPPUNIT_ASSERT_EQUAL(std::string("php"), uri3.getMedia());
+  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu.php"), uri3.getPath().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu"), uri3.getPathWoSuffix().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("wwwtech.de"), uri3.getHost().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("#lala"), uri3.getFragment().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("abc=def"), uri3.getQueryString().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("php"), uri3.getMedia().str());
   CPPUNIT_ASSERT_EQUAL(std::string("https://wwwtech.de:8080/lala/lulu.php?abc=def#lala"), uri3.toString());
 
+  /* copies carry their own buffer */
+  CForum::URI uri4(uri3);
+  uri3 = uri;
+  CPPUNIT_ASSERT_EQUAL(std::string("/lala/lulu.php"), uri4.getPath().str());
+  CPPUNIT_ASSERT(uri4.getMedia() == "php");
+}
+
+void URITest::testToBuffer() {
+  CForum::URI uri("http://wwwtech.de:8080/lala?abc=def");
+  std::string str = uri.toString();
+  char buff[64];
+
+  CPPUNIT_ASSERT_EQUAL(str.length(), uri.toString(buff, sizeof(buff)));
+  CPPUNIT_ASSERT_EQUAL(str, std::string(buff));
+
+  /* too small: cut off, but still terminated, and the full length is reported */
+  CPPUNIT_ASSERT_EQUAL(str.length(), uri.toString(buff, 10));
+  CPPUNIT_ASSERT_EQUAL(std::string("http://ww"), std::string(buff));
+
+  uri.buffer() = "https://example.org/a/b.json";
+  uri.parse();
+  CPPUNIT_ASSERT_EQUAL(std::string("example.org"), uri.getHost().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("/a/b"), uri.getPathWoSuffix().str());
+  CPPUNIT_ASSERT_EQUAL(std::string("json"), uri.getMedia().str());
+  CPPUNIT_ASSERT_EQUAL(443, uri.getPort());
 }
 
 void URITest::testParserGarbage() {
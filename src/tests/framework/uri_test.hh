@@ -39,11 +39,13 @@ class URITest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(URITest);
   CPPUNIT_TEST(testParser);
   CPPUNIT_TEST(testParserGarbage);
+  CPPUNIT_TEST(testToBuffer);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testParser();
   void testParserGarbage();
+  void testToBuffer();
 };
 
 #endif
@@ -0,0 +1,71 @@
+/**
+ * \author Christian Kruse <cjk@wwwtech.de>
+ * \brief URL template testing
+ * \package unittests
+ *
+ * URL template testing
+ */
+
+/*
+ * Copyright (C) 2011 by Christian Kruse <cjk@wwwtech.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "url_template_test.hh"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UrlTemplateTest);
+
+void UrlTemplateTest::testExpand() {
+  CForum::UrlTemplate tpl("<tid>/<mid>#m<mid>");
+  std::string url = "http://example.org/", values[2] = { "t1", "m 2/3" };
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, tpl.getNames().size());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, tpl.indexOf("mid"));
+
+  tpl.expand(url, values, 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("http://example.org/t1/m%202%2F3#mm%202%2F3"), url);
+
+  url.clear();
+  tpl.expand(url, values, 1);
+  CPPUNIT_ASSERT_EQUAL(std::string("t1/#m"), url);
+}
+
+void UrlTemplateTest::testPath() {
+  CForum::UrlTemplate tpl("<tid:path>/<mid>");
+  std::string url = "http://example.org/cforum", values[2] = { "/2011/jan/01/slug", "m/1" };
+
+  CPPUNIT_ASSERT_EQUAL(std::string("tid"), tpl.getNames()[0]);
+
+  tpl.expand(url, values, 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("http://example.org/cforum/2011/jan/01/slug/m%2F1"), url);
+
+  url.clear();
+  tpl.expand(url, values, 1);
+  CPPUNIT_ASSERT_EQUAL(std::string("/2011/jan/01/slug/"), url);
+}
+
+void UrlTemplateTest::testSyntax() {
+  CPPUNIT_ASSERT_THROW(CForum::UrlTemplate("<tid/x"), CForum::RouteSyntaxException);
+  CPPUNIT_ASSERT_THROW(CForum::UrlTemplate("<>/x"), CForum::RouteSyntaxException);
+  CPPUNIT_ASSERT_THROW(CForum::UrlTemplate("<tid:int>/x"), CForum::RouteSyntaxException);
+  CPPUNIT_ASSERT_THROW(CForum::UrlTemplate("<:path>/x"), CForum::RouteSyntaxException);
+}
+
+/* eof */
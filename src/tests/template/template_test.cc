@@ -43,6 +43,108 @@ void TemplateTest::testParser() {
   CPPUNIT_ASSERT_EQUAL(std::string("<head>\n  <title>Test</title>\n</head>\n<body>\n  --\n<h1>'la\nla'</h1>\n<p>Ich, CK, im vollbesitz meiner geistigen kräfte, bin froh. Deshalb...--\n</body>\n"),str);
 }
 
+void TemplateTest::testPoolReset() {
+  v8::HandleScope scope;
+  boost::shared_ptr<CForum::TemplatePool> pool = boost::make_shared<CForum::TemplatePool>();
+  boost::shared_ptr<CForum::Template> tpl = pool->acquire();
+  CForum::Template *first = tpl.get();
 
+  tpl->setVariable("mood", v8::String::New("froh"));
+  tpl->setGlobal("leaked", v8::String::New("yes"));
+  tpl->evaluateString(std::string("<% var counter = 1; %>"));
+
+  tpl.reset();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, pool->getIdleCount());
+
+  tpl = pool->acquire();
+  CPPUNIT_ASSERT(tpl.get() == first);
+
+  std::string str = tpl->evaluateString(std::string("<% _e(_v('mood', 'none')) %>|<% _e(typeof leaked) %>|<% _e(typeof counter) %>"));
+  CPPUNIT_ASSERT_EQUAL(std::string("none|undefined|undefined"), str);
+}
+
+void TemplateTest::testCache() {
+  v8::HandleScope scope;
+  CForum::TemplateCache cache;
+  CForum::Template tpl;
+  std::string fname = "template_cache_test.html";
+
+  tpl.setCache(&cache);
+
+  std::ofstream fd(fname.c_str());
+  fd << "first";
+  fd.close();
+
+  CPPUNIT_ASSERT_EQUAL(std::string("first"), tpl.evaluateFile(fname));
+  CPPUNIT_ASSERT_EQUAL(std::string("first"), tpl.evaluateFile(fname));
+
+  fd.open(fname.c_str());
+  fd << "second one";
+  fd.close();
+
+  CPPUNIT_ASSERT_EQUAL(std::string("second one"), tpl.evaluateFile(fname));
+
+  unlink(fname.c_str());
+  CForum::TemplateCache::clearSources();
+}
+
+void TemplateTest::testRenderFile() {
+  v8::HandleScope scope;
+  CForum::Template tpl;
+  std::ostringstream out;
+  std::string fname = "template_render_test.html";
+
+  std::ofstream fd(fname.c_str());
+  fd << "<h1><% _e(_v('mood', 'none')) %></h1>";
+  fd.close();
+
+  bool extends = true;
+  tpl.parseFile(fname, &extends);
+  CPPUNIT_ASSERT(!extends);
+
+  out << "<body>";
+  tpl.setVariable("mood", v8::String::New("froh"));
+  tpl.renderFile(fname, out);
+
+  CPPUNIT_ASSERT_EQUAL(std::string("<body><h1>froh</h1>"), out.str());
+
+  unlink(fname.c_str());
+}
+
+void TemplateTest::testCallsExtend() {
+  CForum::Template tpl;
+  std::string src;
+  bool extends;
+
+  src = "<p>extended text, extend(me)</p>";
+  tpl.parseString(src.c_str(), src.length(), &extends);
+  CPPUNIT_ASSERT(!extends);
+
+  src = "<% my_extend('a'); obj.extend('b') %>";
+  tpl.parseString(src.c_str(), src.length(), &extends);
+  CPPUNIT_ASSERT(!extends);
+
+  src = "<h1>x</h1><% extend ('layout.html') %>";
+  tpl.parseString(src.c_str(), src.length(), &extends);
+  CPPUNIT_ASSERT(extends);
+}
+
+void TemplateTest::testIndirectExtend() {
+  v8::HandleScope scope;
+  CForum::Template tpl;
+  std::ostringstream out;
+  std::string fname = "template_extend_test.html";
+
+  std::ofstream fd(fname.c_str());
+  fd << "<% wrap() %>body";
+  fd.close();
+
+  tpl.evaluateString(std::string("<% wrap = function() { extend('../../../src/tests/template/lala.html'); } %>"));
+
+  /* we can't tell it from the source, so streaming has to notice */
+  CPPUNIT_ASSERT_THROW(tpl.renderFile(fname, out), CForum::TemplateException);
+
+  unlink(fname.c_str());
+}
 
 /* eof */
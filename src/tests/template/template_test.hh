@@ -34,14 +34,25 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "template/template.hh"
+#include "template/template_pool.hh"
 
 class TemplateTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(TemplateTest);
   CPPUNIT_TEST(testParser);
+  CPPUNIT_TEST(testPoolReset);
+  CPPUNIT_TEST(testCache);
+  CPPUNIT_TEST(testRenderFile);
+  CPPUNIT_TEST(testCallsExtend);
+  CPPUNIT_TEST(testIndirectExtend);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testParser();
+  void testPoolReset();
+  void testCache();
+  void testRenderFile();
+  void testCallsExtend();
+  void testIndirectExtend();
 };
 
 #endif